@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <asiochan/asiochan.hpp>
+
+// Independent buffered channels, each with its own producer and consumer thread.
+// The channels are allocated back to back, so without cache line aligned shared states
+// neighbouring channels end up sharing lines and the pairs slow each other down.
+//
+// The same transfers are also run directly on channel states in a contiguous array,
+// without the waiting of read_sync and write_sync: once on the aligned states of the
+// channels with their masked ring, and once on a baseline of unaligned states with a
+// ring of optional slots indexed with %, as channel states were laid out before.
+
+// Not a power of two, so that the baseline ring has to reduce its indices with %.
+static constexpr auto buffer_size = 48;
+static constexpr auto num_items = 200'000;
+
+using bench_channel = asiochan::channel<int, buffer_size>;
+
+struct baseline_state
+{
+    [[nodiscard]] auto try_write(int const value) -> bool
+    {
+        auto const lock = std::scoped_lock{mutex};
+        if (count == buffer_size)
+        {
+            return false;
+        }
+
+        slots[(head + count++) % buffer_size].emplace(value);
+        return true;
+    }
+
+    [[nodiscard]] auto try_read() -> std::optional<int>
+    {
+        auto const lock = std::scoped_lock{mutex};
+        if (count == 0)
+        {
+            return std::nullopt;
+        }
+
+        --count;
+        return *std::exchange(slots[std::exchange(head, (head + 1) % buffer_size)], std::nullopt);
+    }
+
+    std::mutex mutex;
+    std::size_t head = 0;
+    std::size_t count = 0;
+    std::array<std::optional<int>, buffer_size> slots;
+};
+
+struct aligned_state
+{
+    [[nodiscard]] auto try_write(int const value) -> bool
+    {
+        auto const lock = std::scoped_lock{state.mutex()};
+        if (state.buffer().full())
+        {
+            return false;
+        }
+
+        auto slot = asiochan::detail::send_slot<int>{};
+        slot.write(int{value});
+        state.buffer().enqueue(slot);
+        return true;
+    }
+
+    [[nodiscard]] auto try_read() -> std::optional<int>
+    {
+        auto const lock = std::scoped_lock{state.mutex()};
+        if (state.buffer().empty())
+        {
+            return std::nullopt;
+        }
+
+        auto slot = asiochan::detail::send_slot<int>{};
+        state.buffer().dequeue(slot);
+        return slot.read();
+    }
+
+    bench_channel::shared_state_type state;
+};
+
+template <typename Transfer>
+auto run_pairs(std::size_t const num_pairs, Transfer transfer) -> double
+{
+    auto threads = std::vector<std::thread>{};
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto pair = std::size_t{0}; pair < num_pairs; ++pair)
+    {
+        threads.emplace_back([&transfer, pair]() { transfer.produce(pair); });
+        threads.emplace_back(
+            [&transfer, pair]()
+            {
+                auto sum = 0ll;
+                for (auto i = 0; i < num_items; ++i)
+                {
+                    sum += transfer.consume(pair);
+                }
+                if (sum != static_cast<long long>(num_items) * (num_items - 1) / 2)
+                {
+                    std::abort();
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto const dur = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double>(num_pairs * num_items) / std::chrono::duration<double>{dur}.count();
+}
+
+struct channel_transfer
+{
+    void produce(std::size_t const pair) const
+    {
+        for (auto i = 0; i < num_items; ++i)
+        {
+            channels[pair].write_sync(i);
+        }
+    }
+
+    [[nodiscard]] auto consume(std::size_t const pair) const -> int
+    {
+        return channels[pair].read_sync();
+    }
+
+    std::vector<bench_channel> channels;
+};
+
+template <typename State>
+struct state_transfer
+{
+    void produce(std::size_t const pair) const
+    {
+        for (auto i = 0; i < num_items; ++i)
+        {
+            while (not states[pair].try_write(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    [[nodiscard]] auto consume(std::size_t const pair) const -> int
+    {
+        while (true)
+        {
+            if (auto const value = states[pair].try_read())
+            {
+                return *value;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    mutable std::vector<State> states;
+};
+
+auto main() -> int
+{
+    using shared_state_type = bench_channel::shared_state_type;
+
+    std::cout << "Shared state size: " << sizeof(shared_state_type)
+              << ", alignment: " << alignof(shared_state_type)
+              << "; baseline size: " << sizeof(baseline_state)
+              << ", alignment: " << alignof(baseline_state) << "\n";
+
+    auto const max_pairs = std::max(1u, std::thread::hardware_concurrency() / 2);
+    for (auto num_pairs = 1u; num_pairs <= max_pairs; num_pairs *= 2)
+    {
+        std::cout << num_pairs << " channel(s): "
+                  << run_pairs(num_pairs, channel_transfer{std::vector<bench_channel>(num_pairs)})
+                  << " items/s; states: aligned "
+                  << run_pairs(num_pairs, state_transfer<aligned_state>{std::vector<aligned_state>(num_pairs)})
+                  << " items/s, baseline "
+                  << run_pairs(num_pairs, state_transfer<baseline_state>{std::vector<baseline_state>(num_pairs)})
+                  << " items/s\n";
+    }
+
+    return EXIT_SUCCESS;
+}
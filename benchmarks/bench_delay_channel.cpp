@@ -0,0 +1,51 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include <asiochan/asiochan.hpp>
+
+#ifdef ASIOCHAN_USE_STANDALONE_ASIO
+
+#include <asio/io_context.hpp>
+
+#else
+
+#include <boost/asio/io_context.hpp>
+
+#endif
+
+namespace asio = asiochan::asio;
+
+// Schedules values with random delays of up to an hour into a delay_channel, and
+// reports the cost per write for growing numbers of pending values. With the timing
+// wheel the cost stays flat rather than growing with the number pending.
+
+static constexpr auto max_delay = std::chrono::hours{1};
+
+auto run(std::size_t const num_values) -> double
+{
+    auto context = asio::io_context{};
+    auto const delayed = asiochan::delay_channel<int>{context.get_executor()};
+    auto random = std::mt19937_64{num_values};
+    auto delays = std::uniform_int_distribution<std::chrono::milliseconds::rep>{1, max_delay / std::chrono::milliseconds{1}};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (auto i = std::size_t{0}; i < num_values; ++i)
+    {
+        delayed.write(static_cast<int>(i), std::chrono::milliseconds{delays(random)});
+    }
+    auto const dur = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>{dur}.count() / num_values;
+}
+
+auto main() -> int
+{
+    for (auto num_values = std::size_t{1'000}; num_values <= 1'000'000; num_values *= 10)
+    {
+        std::cout << num_values << " pending: " << run(num_values) << " ns/write\n";
+    }
+
+    return EXIT_SUCCESS;
+}
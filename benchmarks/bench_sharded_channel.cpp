@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <asiochan/asiochan.hpp>
+
+#ifdef ASIOCHAN_USE_STANDALONE_ASIO
+
+#include <asio/thread_pool.hpp>
+#include <asio/use_future.hpp>
+
+#else
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+
+#endif
+
+namespace asio = asiochan::asio;
+
+// As many writers as readers pass values through either one channel or a sharded
+// channel, on an asio::thread_pool with one thread per writer and reader. With more
+// threads, the single channel's lock is contended more, while the sharded channel
+// spreads the threads over its shards.
+
+static constexpr auto buffer_size = 64;
+static constexpr auto num_shards = 8;
+static constexpr auto values_per_writer = 100'000;
+
+template <typename Channel>
+auto run(std::size_t const num_pairs, Channel const channel) -> double
+{
+    auto thread_pool = asio::thread_pool{2 * num_pairs};
+    auto done = std::vector<std::future<void>>{};
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto pair = std::size_t{0}; pair < num_pairs; ++pair)
+    {
+        done.push_back(asio::co_spawn(
+            thread_pool,
+            [channel]() -> asio::awaitable<void>
+            {
+                for (auto value = 0; value < values_per_writer; ++value)
+                {
+                    co_await channel.write(value);
+                }
+            },
+            asio::use_future));
+        done.push_back(asio::co_spawn(
+            thread_pool,
+            [channel]() -> asio::awaitable<void>
+            {
+                for (auto i = 0; i < values_per_writer; ++i)
+                {
+                    static_cast<void>(co_await channel.read());
+                }
+            },
+            asio::use_future));
+    }
+    for (auto& future : done)
+    {
+        future.get();
+    }
+
+    auto const dur = std::chrono::steady_clock::now() - start;
+
+    return num_pairs * values_per_writer / std::chrono::duration<double>{dur}.count();
+}
+
+auto main() -> int
+{
+    auto const max_threads = std::max(2u, std::thread::hardware_concurrency());
+    for (auto num_pairs = 1u; 2 * num_pairs <= max_threads; num_pairs *= 2)
+    {
+        auto const single_rate = run(num_pairs, asiochan::channel<int, buffer_size>{});
+        auto const sharded_rate = run(num_pairs, asiochan::sharded_channel<int, buffer_size, num_shards>{});
+
+        std::cout << 2 * num_pairs << " thread(s): channel " << single_rate
+                  << " values/s, sharded channel " << sharded_rate << " values/s\n";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include <asiochan/asiochan.hpp>
+
+#ifdef ASIOCHAN_USE_STANDALONE_ASIO
+
+#include <asio/io_context.hpp>
+
+#else
+
+#include <boost/asio/io_context.hpp>
+
+#endif
+
+namespace asio = asiochan::asio;
+
+// Compares the per-operation overhead of plain read() and write(), which take the
+// single operation path, with the same operations through select() on a single
+// threaded io_context. "ready" operations find a value or buffer space right away;
+// "waiting" operations ping-pong between two coroutines over unbuffered channels, so
+// every operation has to wait.
+
+static constexpr auto num_ops = 1'000'000;
+
+using buffered_channel = asiochan::channel<int, 64>;
+using unbuffered_channel = asiochan::channel<int>;
+
+template <typename Body>
+auto time_ops(Body body) -> double
+{
+    auto context = asio::io_context{};
+    auto const start = std::chrono::steady_clock::now();
+    body(context);
+    context.run();
+    auto const dur = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>{dur}.count() / num_ops;
+}
+
+template <bool use_select>
+auto ready(asio::io_context& context)
+{
+    asio::co_spawn(
+        context,
+        []() -> asio::awaitable<void>
+        {
+            auto const channel = buffered_channel{};
+            for (auto i = 0; i < num_ops / 2; ++i)
+            {
+                if constexpr (use_select)
+                {
+                    co_await asiochan::select(asiochan::ops::write(i, channel));
+                    co_await asiochan::select(asiochan::ops::read(channel));
+                }
+                else
+                {
+                    co_await channel.write(i);
+                    co_await channel.read();
+                }
+            }
+        },
+        asio::detached);
+}
+
+template <bool use_select>
+auto waiting(asio::io_context& context)
+{
+    auto const ping = unbuffered_channel{};
+    auto const pong = unbuffered_channel{};
+
+    auto const echo = [](unbuffered_channel const in, unbuffered_channel const out, int const count) -> asio::awaitable<void>
+    {
+        for (auto i = 0; i < count; ++i)
+        {
+            if constexpr (use_select)
+            {
+                auto const result = co_await asiochan::select(asiochan::ops::read(in));
+                co_await asiochan::select(asiochan::ops::write(result.template get_received<int>(), out));
+            }
+            else
+            {
+                co_await out.write(co_await in.read());
+            }
+        }
+    };
+
+    // Every round trip is two reads and two writes.
+    asio::co_spawn(context, echo(ping, pong, num_ops / 4), asio::detached);
+    asio::co_spawn(
+        context,
+        [ping, pong]() -> asio::awaitable<void>
+        {
+            for (auto i = 0; i < num_ops / 4; ++i)
+            {
+                if constexpr (use_select)
+                {
+                    co_await asiochan::select(asiochan::ops::write(i, ping));
+                    co_await asiochan::select(asiochan::ops::read(pong));
+                }
+                else
+                {
+                    co_await ping.write(i);
+                    co_await pong.read();
+                }
+            }
+        },
+        asio::detached);
+}
+
+auto main() -> int
+{
+    std::cout << "ready:   read/write " << time_ops(ready<false>) << " ns/op, select "
+              << time_ops(ready<true>) << " ns/op\n";
+    std::cout << "waiting: read/write " << time_ops(waiting<false>) << " ns/op, select "
+              << time_ops(waiting<true>) << " ns/op\n";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <asiochan/asiochan.hpp>
+
+#ifdef ASIOCHAN_USE_STANDALONE_ASIO
+
+#include <asio/thread_pool.hpp>
+#include <asio/use_future.hpp>
+
+#else
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+
+#endif
+
+namespace asio = asiochan::asio;
+
+// Thousands of coroutines each wait on a few of a set of unbuffered channels at once.
+// Every value wakes one of them, and leaves the waiters of that select on its other
+// channels behind. The time per value shows how quickly these losing waiters are cleared.
+// Build with ASIOCHAN_CH_WAITER_STATS to also print how many of them later operations
+// had to skip.
+
+static constexpr auto num_channels = 64;
+static constexpr auto num_selectors = 4096;
+static constexpr auto channels_per_select = 4;
+static constexpr auto num_writers = 8;
+static constexpr auto values_per_writer = 50'000;
+
+using data_channel = asiochan::channel<int>;
+
+auto main() -> int
+{
+    auto const num_threads = std::max(2u, std::thread::hardware_concurrency());
+    auto thread_pool = asio::thread_pool{num_threads};
+    auto const channels = std::vector<data_channel>(num_channels);
+    auto const stop = asiochan::channel<void>{};
+
+    auto random = std::mt19937{42};
+    auto pick = std::uniform_int_distribution<std::size_t>{0, num_channels - 1};
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto selector = 0; selector < num_selectors; ++selector)
+    {
+        // Every channel has a selector that waits on it first.
+        auto subset = std::vector<data_channel>{channels[selector % num_channels]};
+        for (auto i = 1; i < channels_per_select; ++i)
+        {
+            subset.push_back(channels[pick(random)]);
+        }
+
+        asio::co_spawn(
+            thread_pool,
+            [subset = std::move(subset), stop]() mutable -> asio::awaitable<void>
+            {
+                while (true)
+                {
+                    auto const result = co_await asiochan::select(
+                        asiochan::ops::read_any(std::span{subset}),
+                        asiochan::ops::read(stop));
+                    if (result.received_from(stop))
+                    {
+                        co_return;
+                    }
+                }
+            },
+            asio::detached);
+    }
+
+    auto writers = std::vector<std::future<void>>{};
+    for (auto writer = 0; writer < num_writers; ++writer)
+    {
+        writers.push_back(asio::co_spawn(
+            thread_pool,
+            [&channels, seed = writer]() -> asio::awaitable<void>
+            {
+                auto random = std::mt19937{static_cast<unsigned>(seed)};
+                auto pick = std::uniform_int_distribution<std::size_t>{0, num_channels - 1};
+                for (auto value = 0; value < values_per_writer; ++value)
+                {
+                    co_await channels[pick(random)].write(value);
+                }
+            },
+            asio::use_future));
+    }
+    for (auto& writer : writers)
+    {
+        writer.get();
+    }
+
+    auto const dur = std::chrono::steady_clock::now() - start;
+
+    for (auto selector = 0; selector < num_selectors; ++selector)
+    {
+        stop.write_sync();
+    }
+    thread_pool.join();
+
+    constexpr auto num_values = num_writers * values_per_writer;
+    std::cout << num_selectors << " selectors over " << num_channels << " channels: "
+              << std::chrono::duration<double, std::nano>{dur}.count() / num_values << " ns per value\n";
+
+#ifdef ASIOCHAN_CH_WAITER_STATS
+    auto enqueued = std::size_t{0};
+    auto removed = std::size_t{0};
+    auto skipped = std::size_t{0};
+    for (auto const& channel : channels)
+    {
+        auto const& stats = channel.shared_state_ptr()->reader_list().stats();
+        enqueued += stats.enqueued;
+        removed += stats.removed;
+        skipped += stats.skipped;
+    }
+    std::cout << "waiters: " << enqueued << " enqueued, " << removed << " removed, "
+              << skipped << " skipped\n";
+#endif
+
+    return EXIT_SUCCESS;
+}
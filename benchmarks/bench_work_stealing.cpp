@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <asiochan/asiochan.hpp>
+
+#ifdef ASIOCHAN_USE_STANDALONE_ASIO
+
+#include <asio/thread_pool.hpp>
+#include <asio/use_future.hpp>
+
+#else
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+
+#endif
+
+namespace asio = asiochan::asio;
+
+// Workers on an asio::thread_pool process tasks of uneven cost, taken either from one
+// shared channel or from a work stealing pool with a channel per worker. The producer
+// writes round robin, so with the pool some workers fall behind on expensive tasks and
+// the others have to steal.
+
+static constexpr auto buffer_size = 64;
+static constexpr auto num_tasks = 200'000;
+static constexpr auto stop = -1;
+
+// Every 16th task is a hundred times as expensive as the others.
+auto process(int const task) -> unsigned
+{
+    auto const cost = task % 16 == 0 ? 2000 : 20;
+    auto result = static_cast<unsigned>(task);
+    for (auto i = 0; i < cost; ++i)
+    {
+        result = result * 1664525u + 1013904223u;
+    }
+    return result;
+}
+
+struct progress
+{
+    std::atomic_int processed = 0;
+    asiochan::channel<void, 1> done;
+
+    auto count() -> asio::awaitable<void>
+    {
+        if (processed.fetch_add(1, std::memory_order_relaxed) + 1 == num_tasks)
+        {
+            co_await done.write();
+        }
+    }
+};
+
+template <typename Read, typename Write>
+auto run(std::size_t const num_workers, Read read, Write write) -> double
+{
+    auto thread_pool = asio::thread_pool{num_workers};
+    auto state = std::make_shared<progress>();
+    auto checksum = std::make_shared<std::atomic_uint>(0);
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto worker = std::size_t{0}; worker < num_workers; ++worker)
+    {
+        asio::co_spawn(
+            thread_pool,
+            [=]() -> asio::awaitable<void>
+            {
+                auto local = 0u;
+                for (auto task = co_await read(worker); task != stop; task = co_await read(worker))
+                {
+                    local += process(task);
+                    co_await state->count();
+                }
+                checksum->fetch_add(local, std::memory_order_relaxed);
+            },
+            asio::detached);
+    }
+
+    asio::co_spawn(
+        thread_pool,
+        [=]() -> asio::awaitable<void>
+        {
+            for (auto task = 0; task < num_tasks; ++task)
+            {
+                co_await write(task);
+            }
+            co_await state->done.read();
+            for (auto worker = std::size_t{0}; worker < num_workers; ++worker)
+            {
+                co_await write(stop);
+            }
+        },
+        asio::use_future)
+        .get();
+
+    thread_pool.join();
+
+    auto const dur = std::chrono::steady_clock::now() - start;
+
+    return num_tasks / std::chrono::duration<double>{dur}.count();
+}
+
+auto main() -> int
+{
+    auto const max_workers = std::max(2u, std::thread::hardware_concurrency());
+    for (auto num_workers = 2u; num_workers <= max_workers; num_workers *= 2)
+    {
+        auto const shared = asiochan::channel<int, buffer_size>{};
+        auto const shared_rate = run(
+            num_workers,
+            [shared](std::size_t) { return shared.read(); },
+            [shared](int const task) { return shared.write(task); });
+
+        auto const pool = asiochan::work_stealing_pool<int, buffer_size>{num_workers};
+        auto const pool_rate = run(
+            num_workers,
+            [pool](std::size_t const worker) { return pool.read(worker); },
+            [pool](int const task) { return pool.submit(task); });
+
+        std::cout << num_workers << " worker(s): shared channel " << shared_rate
+                  << " tasks/s, work stealing pool " << pool_rate << " tasks/s\n";
+    }
+
+    return EXIT_SUCCESS;
+}
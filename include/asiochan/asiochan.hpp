@@ -2,11 +2,27 @@
 
 #include "asiochan/asio.hpp"
 #include "asiochan/async_promise.hpp"
+#include "asiochan/byte_budget.hpp"
 #include "asiochan/channel.hpp"
 #include "asiochan/channel_buff_size.hpp"
 #include "asiochan/channel_concepts.hpp"
+#include "asiochan/channel_eventfd.hpp"
+#include "asiochan/channel_mutex.hpp"
+#include "asiochan/channel_ref.hpp"
+#include "asiochan/channel_set.hpp"
+#include "asiochan/delay_channel.hpp"
 #include "asiochan/nothing_op.hpp"
+#include "asiochan/pipeline.hpp"
+#include "asiochan/rate_limited.hpp"
+#include "asiochan/read_any_op.hpp"
 #include "asiochan/read_op.hpp"
+#include "asiochan/remote.hpp"
 #include "asiochan/select.hpp"
+#include "asiochan/selector.hpp"
 #include "asiochan/sendable.hpp"
+#include "asiochan/sharded_channel.hpp"
+#include "asiochan/shm_channel.hpp"
+#include "asiochan/spill_options.hpp"
+#include "asiochan/ticker.hpp"
+#include "asiochan/work_stealing_pool.hpp"
 #include "asiochan/write_op.hpp"
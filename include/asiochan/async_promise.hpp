@@ -106,6 +106,21 @@ namespace asiochan
                 std::bind_front(consume_impl(), nullptr, T{std::forward<U>(value)}));
         }
 
+        // Completes the promise like set_value, but returns the continuation instead of
+        // posting it. It must be invoked on get_executor(), e.g. together with others.
+        template <std::convertible_to<T> U>
+        [[nodiscard]] auto release_with_value(U&& value)
+        {
+            assert(valid());
+            return std::bind_front(consume_impl(), nullptr, T{std::forward<U>(value)});
+        }
+
+        [[nodiscard]] auto get_executor() const
+        {
+            assert(valid());
+            return asio::get_associated_executor(*impl_);
+        }
+
         void set_value() requires std::is_void_v<T>
         {
             assert(valid());
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+namespace asiochan
+{
+    // The memory budget of a budgeted_channel_buff channel. size_of accounts the bytes of
+    // each buffered value. Writers wait once the buffered values take limit bytes or more,
+    // until readers have taken enough values for usage to drop below low_watermark (the
+    // limit, unless given).
+    template <typename T>
+    struct byte_budget
+    {
+        std::size_t limit = 0;
+        std::optional<std::size_t> low_watermark = std::nullopt;
+        std::function<std::size_t(T const&)> size_of = [](T const&) { return sizeof(T); };
+    };
+}  // namespace asiochan
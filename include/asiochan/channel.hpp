@@ -1,18 +1,25 @@
 #pragma once
 
 #include <concepts>
-#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
 #include <source_location>
 #endif
 
 #include "asiochan/asio.hpp"
+#include "asiochan/byte_budget.hpp"
 #include "asiochan/channel_buff_size.hpp"
 #include "asiochan/channel_concepts.hpp"
+#include "asiochan/channel_mutex.hpp"
+#include "asiochan/channel_ref.hpp"
 #include "asiochan/detail/allocate_tracer.hpp"
 #include "asiochan/detail/channel_method_ops.hpp"
 #include "asiochan/detail/channel_shared_state.hpp"
+#include "asiochan/detail/intrusive_ptr.hpp"
 #include "asiochan/sendable.hpp"
+#include "asiochan/spill_options.hpp"
 
 namespace asiochan
 {
@@ -37,13 +44,15 @@ namespace asiochan
     template <sendable T,
               channel_buff_size buff_size_,
               channel_flags flags_,
-              asio::execution::executor Executor>
+              asio::execution::executor Executor,
+              channel_mutex Mutex = std::mutex>
     class channel_base
     {
       public:
         using executor_type = Executor;
-        using shared_state_type = detail::channel_shared_state<T, Executor, buff_size_, flags_is_forget_oldest(flags_)>;
-        using shared_state_ptr_type = std::shared_ptr<shared_state_type>;
+        using mutex_type = Mutex;
+        using shared_state_type = detail::channel_shared_state<T, Executor, buff_size_, flags_is_forget_oldest(flags_), Mutex>;
+        using shared_state_ptr_type = detail::intrusive_ptr<shared_state_type>;
         using send_type = T;
 
         static constexpr auto flags = flags_;
@@ -51,24 +60,80 @@ namespace asiochan
 
         static_assert(!flags_is_forget_oldest(flags) or buff_size > 0, "The buff_size must greater than zero when stream_mode is forget_oldest");
 
+        // clang-format off
         [[nodiscard]] channel_base(
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
             const std::source_location& src_loc
 #endif
             )
-          : shared_state_{std::make_shared<shared_state_type>(
+        requires (not is_dynamic(buff_size_) and not is_budgeted(buff_size_))
+          : shared_state_{detail::make_intrusive<shared_state_type>(
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
                 src_loc
 #endif
                 )}
+        // clang-format on
+        {
+        }
+
+        // clang-format off
+        [[nodiscard]] explicit channel_base(
+            std::size_t const capacity
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+            , const std::source_location& src_loc
+#endif
+            )
+        requires (is_dynamic(buff_size_))
+          : shared_state_{detail::make_intrusive<shared_state_type>(
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+                src_loc,
+#endif
+                capacity)}
+        // clang-format on
+        {
+        }
+
+        // clang-format off
+        [[nodiscard]] explicit channel_base(
+            byte_budget<T> budget
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+            , const std::source_location& src_loc
+#endif
+            )
+        requires (is_budgeted(buff_size_))
+          : shared_state_{detail::make_intrusive<shared_state_type>(
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+                src_loc,
+#endif
+                std::move(budget))}
+        // clang-format on
+        {
+        }
+
+#ifdef ASIOCHAN_HAS_SPILL
+        // clang-format off
+        [[nodiscard]] explicit channel_base(
+            spill_options options
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+            , const std::source_location& src_loc
+#endif
+            )
+        requires (is_unbounded(buff_size_) and std::is_trivially_copyable_v<T>)
+          : shared_state_{detail::make_intrusive<shared_state_type>(
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+                src_loc,
+#endif
+                std::move(options))}
+        // clang-format on
         {
         }
+#endif
 
         // clang-format off
         template <channel_flags other_flags>
         requires (flags_convertable_to(other_flags, flags))
         [[nodiscard]] channel_base(
-            channel_base<T, buff_size_, other_flags, Executor> const& other) noexcept
+            channel_base<T, buff_size_, other_flags, Executor, Mutex> const& other) noexcept
           : shared_state_{other.shared_state_}
         // clang-format on
         {
@@ -78,7 +143,7 @@ namespace asiochan
         template <channel_flags other_flags>
         requires (flags_convertable_to(other_flags, flags))
         [[nodiscard]] channel_base(
-            channel_base<T, buff_size_, other_flags, Executor>&& other) noexcept
+            channel_base<T, buff_size_, other_flags, Executor, Mutex>&& other) noexcept
           : shared_state_{std::move(other.shared_state_)}
         // clang-format on
         {
@@ -86,7 +151,7 @@ namespace asiochan
 
         template <channel_flags other_flags>
         requires (flags_convertable_to(other_flags, flags))
-        channel_base<T, buff_size_, flags_, Executor>& operator=(channel_base<T, buff_size_, other_flags, Executor> const& other) noexcept
+        channel_base<T, buff_size_, flags_, Executor, Mutex>& operator=(channel_base<T, buff_size_, other_flags, Executor, Mutex> const& other) noexcept
         {
             shared_state_ = other.shared_state_;
             return *this;
@@ -94,7 +159,7 @@ namespace asiochan
 
         template <channel_flags other_flags>
         requires (flags_convertable_to(other_flags, flags))
-        channel_base<T, buff_size_, flags_, Executor>& operator=(channel_base<T, buff_size_, other_flags, Executor>&& other) noexcept
+        channel_base<T, buff_size_, flags_, Executor, Mutex>& operator=(channel_base<T, buff_size_, other_flags, Executor, Mutex>&& other) noexcept
         {
             shared_state_ = std::move(other.shared_state_);
             return *this;
@@ -115,6 +180,23 @@ namespace asiochan
             return shared_state_;
         }
 
+        // clang-format off
+        [[nodiscard]] auto capacity() const -> std::size_t
+        requires (is_dynamic(buff_size_))
+        // clang-format on
+        {
+            return shared_state_->capacity();
+        }
+
+        // Throws std::invalid_argument for a capacity of zero.
+        // clang-format off
+        void set_capacity(std::size_t const capacity) const
+        requires (is_dynamic(buff_size_))
+        // clang-format on
+        {
+            shared_state_->set_capacity(capacity);
+        }
+
         [[nodiscard]] friend auto operator==(
             channel_base const& lhs,
             channel_base const& rhs) noexcept -> bool
@@ -124,20 +206,24 @@ namespace asiochan
         ~channel_base() noexcept = default;
 
       private:
-        template <sendable, channel_buff_size, channel_flags, asio::execution::executor>
+        template <sendable, channel_buff_size, channel_flags, asio::execution::executor, channel_mutex>
         friend class channel_base;
 
         shared_state_ptr_type shared_state_;
     };
 
-    template <sendable T, channel_buff_size buff_size, channel_stream_mode stream_mode, asio::execution::executor Executor>
+    template <sendable T,
+              channel_buff_size buff_size,
+              channel_stream_mode stream_mode,
+              asio::execution::executor Executor,
+              channel_mutex Mutex = std::mutex>
     class basic_channel
-      : public channel_base<T, buff_size, make_channel_flags(bidirectional, stream_mode), Executor>,
-        public detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(bidirectional, stream_mode), basic_channel<T, buff_size, stream_mode, Executor>>
+      : public channel_base<T, buff_size, make_channel_flags(bidirectional, stream_mode), Executor, Mutex>,
+        public detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(bidirectional, stream_mode), basic_channel<T, buff_size, stream_mode, Executor, Mutex>>
     {
       private:
-        using base = channel_base<T, buff_size, make_channel_flags(bidirectional, stream_mode), Executor>;
-        using ops = detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(bidirectional, stream_mode), basic_channel<T, buff_size, stream_mode, Executor>>;
+        using base = channel_base<T, buff_size, make_channel_flags(bidirectional, stream_mode), Executor, Mutex>;
+        using ops = detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(bidirectional, stream_mode), basic_channel<T, buff_size, stream_mode, Executor, Mutex>>;
 
       public:
         using base::base;
@@ -153,18 +239,37 @@ namespace asiochan
 
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
         basic_channel(const std::source_location& src_loc = std::source_location::current())
+        requires (not is_dynamic(buff_size) and not is_budgeted(buff_size))
           : base(src_loc) { }
+
+        explicit basic_channel(std::size_t capacity, const std::source_location& src_loc = std::source_location::current())
+        requires (is_dynamic(buff_size))
+          : base(capacity, src_loc) { }
+
+        explicit basic_channel(byte_budget<T> budget, const std::source_location& src_loc = std::source_location::current())
+        requires (is_budgeted(buff_size))
+          : base(std::move(budget), src_loc) { }
+
+#ifdef ASIOCHAN_HAS_SPILL
+        explicit basic_channel(spill_options options, const std::source_location& src_loc = std::source_location::current())
+        requires (is_unbounded(buff_size) and std::is_trivially_copyable_v<T>)
+          : base(std::move(options), src_loc) { }
+#endif
 #endif
     };
 
-    template <sendable T, channel_buff_size buff_size, channel_stream_mode stream_mode, asio::execution::executor Executor>
+    template <sendable T,
+              channel_buff_size buff_size,
+              channel_stream_mode stream_mode,
+              asio::execution::executor Executor,
+              channel_mutex Mutex = std::mutex>
     class basic_read_channel
-      : public channel_base<T, buff_size, make_channel_flags(readable, stream_mode), Executor>,
-        public detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(readable, stream_mode), basic_read_channel<T, buff_size, stream_mode, Executor>>
+      : public channel_base<T, buff_size, make_channel_flags(readable, stream_mode), Executor, Mutex>,
+        public detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(readable, stream_mode), basic_read_channel<T, buff_size, stream_mode, Executor, Mutex>>
     {
       private:
-        using base = channel_base<T, buff_size, make_channel_flags(readable, stream_mode), Executor>;
-        using ops = detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(readable, stream_mode), basic_read_channel<T, buff_size, stream_mode, Executor>>;
+        using base = channel_base<T, buff_size, make_channel_flags(readable, stream_mode), Executor, Mutex>;
+        using ops = detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(readable, stream_mode), basic_read_channel<T, buff_size, stream_mode, Executor, Mutex>>;
 
       public:
         using base::base;
@@ -175,18 +280,37 @@ namespace asiochan
 
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
         basic_read_channel(const std::source_location& src_loc = std::source_location::current())
+        requires (not is_dynamic(buff_size) and not is_budgeted(buff_size))
           : base(src_loc) { }
+
+        explicit basic_read_channel(std::size_t capacity, const std::source_location& src_loc = std::source_location::current())
+        requires (is_dynamic(buff_size))
+          : base(capacity, src_loc) { }
+
+        explicit basic_read_channel(byte_budget<T> budget, const std::source_location& src_loc = std::source_location::current())
+        requires (is_budgeted(buff_size))
+          : base(std::move(budget), src_loc) { }
+
+#ifdef ASIOCHAN_HAS_SPILL
+        explicit basic_read_channel(spill_options options, const std::source_location& src_loc = std::source_location::current())
+        requires (is_unbounded(buff_size) and std::is_trivially_copyable_v<T>)
+          : base(std::move(options), src_loc) { }
+#endif
 #endif
     };
 
-    template <sendable T, channel_buff_size buff_size, channel_stream_mode stream_mode, asio::execution::executor Executor>
+    template <sendable T,
+              channel_buff_size buff_size,
+              channel_stream_mode stream_mode,
+              asio::execution::executor Executor,
+              channel_mutex Mutex = std::mutex>
     class basic_write_channel
-      : public channel_base<T, buff_size, make_channel_flags(writable, stream_mode), Executor>,
-        public detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(writable, stream_mode), basic_write_channel<T, buff_size, stream_mode, Executor>>
+      : public channel_base<T, buff_size, make_channel_flags(writable, stream_mode), Executor, Mutex>,
+        public detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(writable, stream_mode), basic_write_channel<T, buff_size, stream_mode, Executor, Mutex>>
     {
       private:
-        using base = channel_base<T, buff_size, make_channel_flags(writable, stream_mode), Executor>;
-        using ops = detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(writable, stream_mode), basic_write_channel<T, buff_size, stream_mode, Executor>>;
+        using base = channel_base<T, buff_size, make_channel_flags(writable, stream_mode), Executor, Mutex>;
+        using ops = detail::channel_method_ops<T, Executor, buff_size, make_channel_flags(writable, stream_mode), basic_write_channel<T, buff_size, stream_mode, Executor, Mutex>>;
 
       public:
         using base::base;
@@ -197,7 +321,22 @@ namespace asiochan
 
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
         basic_write_channel(const std::source_location& src_loc = std::source_location::current())
+        requires (not is_dynamic(buff_size) and not is_budgeted(buff_size))
           : base(src_loc) { }
+
+        explicit basic_write_channel(std::size_t capacity, const std::source_location& src_loc = std::source_location::current())
+        requires (is_dynamic(buff_size))
+          : base(capacity, src_loc) { }
+
+        explicit basic_write_channel(byte_budget<T> budget, const std::source_location& src_loc = std::source_location::current())
+        requires (is_budgeted(buff_size))
+          : base(std::move(budget), src_loc) { }
+
+#ifdef ASIOCHAN_HAS_SPILL
+        explicit basic_write_channel(spill_options options, const std::source_location& src_loc = std::source_location::current())
+        requires (is_unbounded(buff_size) and std::is_trivially_copyable_v<T>)
+          : base(std::move(options), src_loc) { }
+#endif
 #endif
     };
 
@@ -222,6 +361,24 @@ namespace asiochan
     requires is_not_zero<buff_size>::value
     using unblocked_write_channel = write_channel<T, buff_size, channel_stream_mode::forget_oldest>;
 
+    template <sendable T, channel_stream_mode stream_mode = channel_stream_mode::block_until_available>
+    using dynamic_channel = channel<T, dynamic_channel_buff, stream_mode>;
+
+    template <sendable T, channel_stream_mode stream_mode = channel_stream_mode::block_until_available>
+    using dynamic_read_channel = read_channel<T, dynamic_channel_buff, stream_mode>;
+
+    template <sendable T, channel_stream_mode stream_mode = channel_stream_mode::block_until_available>
+    using dynamic_write_channel = write_channel<T, dynamic_channel_buff, stream_mode>;
+
+    template <sendable T, channel_stream_mode stream_mode = channel_stream_mode::block_until_available>
+    using budgeted_channel = channel<T, budgeted_channel_buff, stream_mode>;
+
+    template <sendable T, channel_stream_mode stream_mode = channel_stream_mode::block_until_available>
+    using budgeted_read_channel = read_channel<T, budgeted_channel_buff, stream_mode>;
+
+    template <sendable T, channel_stream_mode stream_mode = channel_stream_mode::block_until_available>
+    using budgeted_write_channel = write_channel<T, budgeted_channel_buff, stream_mode>;
+
     template <sendable T>
     using unbounded_channel = channel<T, unbounded_channel_buff>;
 
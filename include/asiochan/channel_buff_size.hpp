@@ -10,11 +10,25 @@ namespace asiochan
 
     inline constexpr auto unbounded_channel_buff = std::numeric_limits<channel_buff_size>::max();
 
+    inline constexpr auto dynamic_channel_buff = unbounded_channel_buff - 1;
+
+    inline constexpr auto budgeted_channel_buff = unbounded_channel_buff - 2;
+
     constexpr bool is_unbounded(channel_buff_size buffer_size)
     {
         return buffer_size == unbounded_channel_buff;
     }
 
+    constexpr bool is_dynamic(channel_buff_size buffer_size)
+    {
+        return buffer_size == dynamic_channel_buff;
+    }
+
+    constexpr bool is_budgeted(channel_buff_size buffer_size)
+    {
+        return buffer_size == budgeted_channel_buff;
+    }
+
     template<channel_buff_size buff_size>
     struct is_not_zero : std::true_type {};
 
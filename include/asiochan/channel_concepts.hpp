@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <type_traits>
 
 #include "asiochan/detail/channel_shared_state.hpp"
 
@@ -63,6 +64,12 @@ namespace asiochan
         { channel.shared_state_ptr() } noexcept -> std::same_as<const typename T::shared_state_ptr_type&>;
     };
 
+    // Handles that refer to a channel without owning it, like channel_ref. Operations
+    // store them by value rather than by reference.
+    template <typename T>
+    concept borrowed_channel_type
+        = any_channel_type<T> and requires { requires T::borrowed; };
+
     template <typename T>
     concept any_readable_channel_type
         = any_channel_type<T> and flags_is_readable(T::flags);
@@ -99,6 +106,9 @@ namespace asiochan
     template <typename T>
     concept any_unbounded_bidirectional_channel_type = any_bidirectional_channel_type<T> and is_unbounded(T::buff_size);
 
+    template <typename T>
+    concept any_dynamic_channel_type = any_channel_type<T> and is_dynamic(T::buff_size);
+
     template <typename T, typename SendType>
     concept channel_type
         = any_channel_type<T> and std::same_as<SendType, typename T::send_type>;
@@ -131,6 +141,10 @@ namespace asiochan
     concept unblocked_bidirectional_channel_type
         = channel_type<T, SendType> and any_unblocked_bidirectional_channel_type<T>;
 
+    template <typename T, typename SendType>
+    concept dynamic_channel_type
+        = any_dynamic_channel_type<T> and std::same_as<SendType, typename T::send_type>;
+
     template <typename T, typename SendType>
     concept unbounded_channel_type
         = any_unbounded_channel_type<T> and std::same_as<SendType, typename T::send_type>;
@@ -147,4 +161,11 @@ namespace asiochan
     concept unbounded_bidirectional_channel_type
         = channel_type<T, SendType> and any_unbounded_bidirectional_channel_type<T>;
     // clang-format on
+
+    namespace detail
+    {
+        // How an operation stores a channel it was given.
+        template <any_channel_type T>
+        using op_channel_storage_t = std::conditional_t<borrowed_channel_type<T>, std::remove_const_t<T>, T&>;
+    }  // namespace detail
 }  // namespace asiochan
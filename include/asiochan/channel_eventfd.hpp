@@ -0,0 +1,168 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+#include <variant>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "asiochan/channel_concepts.hpp"
+#include "asiochan/detail/channel_observer.hpp"
+
+namespace asiochan
+{
+    namespace detail
+    {
+        // An edge-triggered event: set() writes to the eventfd once, until the event is
+        // consumed. Any number of set() calls in between are folded into that one write.
+        class eventfd_event
+        {
+          public:
+            eventfd_event()
+              : fd_{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
+            {
+                if (fd_ < 0)
+                {
+                    throw std::system_error{errno, std::system_category(), "eventfd"};
+                }
+            }
+
+            eventfd_event(eventfd_event const&) = delete;
+            auto operator=(eventfd_event const&) -> eventfd_event& = delete;
+
+            ~eventfd_event() noexcept
+            {
+                ::close(fd_);
+            }
+
+            [[nodiscard]] auto fd() const noexcept -> int
+            {
+                return fd_;
+            }
+
+            void set() noexcept
+            {
+                if (armed_.exchange(false, std::memory_order_acq_rel))
+                {
+                    // Cannot fail: the counter is reset before the event is armed again.
+                    static_cast<void>(::eventfd_write(fd_, 1));
+                }
+            }
+
+            void consume() noexcept
+            {
+                auto count = ::eventfd_t{};
+                static_cast<void>(::eventfd_read(fd_, &count));
+                armed_.store(true, std::memory_order_release);
+            }
+
+          private:
+            int fd_;
+            std::atomic_bool armed_ = true;
+        };
+    }  // namespace detail
+
+    // Exposes the readiness of a channel as eventfd file descriptors, so that event loops
+    // outside of asio, e.g. a plain epoll loop, can wait on channels without polling.
+    //
+    // The readable fd becomes readable after a value was written to the channel, and
+    // stays so until consume_readable() is called. It signals again only for values
+    // written after that, so a reader should drain the channel with try_read() after
+    // consuming. For channels whose writes can wait, the writable fd reports in the same
+    // way that a write would not wait anymore. Events can be spurious if another
+    // coroutine read or wrote first.
+    //
+    // A channel can be observed by a single channel_eventfd or channel_set at a time;
+    // otherwise the constructor throws std::logic_error.
+    // The fds are closed when the channel_eventfd is destroyed.
+    template <any_channel_type Channel>
+    class channel_eventfd final : private detail::channel_observer
+    {
+      public:
+        using channel_type = Channel;
+
+        static constexpr auto reports_writable = not Channel::shared_state_type::write_never_waits;
+
+        explicit channel_eventfd(Channel const& channel)
+          : channel_{channel}
+        {
+            auto& channel_state = *channel_.shared_state_ptr();
+            auto const lock = std::scoped_lock{channel_state.mutex()};
+            channel_state.set_observer(this);
+
+            if (channel_state.readable())
+            {
+                readable_.set();
+            }
+            if constexpr (reports_writable)
+            {
+                if (channel_state.writable())
+                {
+                    writable_.set();
+                }
+            }
+        }
+
+        channel_eventfd(channel_eventfd const&) = delete;
+        auto operator=(channel_eventfd const&) -> channel_eventfd& = delete;
+
+        ~channel_eventfd() noexcept
+        {
+            auto& channel_state = *channel_.shared_state_ptr();
+            auto const lock = std::scoped_lock{channel_state.mutex()};
+            channel_state.set_observer(nullptr);
+        }
+
+        [[nodiscard]] auto readable_fd() const noexcept -> int
+        {
+            return readable_.fd();
+        }
+
+        // clang-format off
+        [[nodiscard]] auto writable_fd() const noexcept -> int
+        requires reports_writable
+        // clang-format on
+        {
+            return writable_.fd();
+        }
+
+        void consume_readable() noexcept
+        {
+            readable_.consume();
+        }
+
+        // clang-format off
+        void consume_writable() noexcept
+        requires reports_writable
+        // clang-format on
+        {
+            writable_.consume();
+        }
+
+      private:
+        void on_readable() noexcept override
+        {
+            readable_.set();
+        }
+
+        void on_writable() noexcept override
+        {
+            if constexpr (reports_writable)
+            {
+                writable_.set();
+            }
+        }
+
+        Channel channel_;
+        detail::eventfd_event readable_;
+        [[no_unique_address]] std::conditional_t<reports_writable, detail::eventfd_event, std::monostate> writable_;
+    };
+}  // namespace asiochan
+
+#endif
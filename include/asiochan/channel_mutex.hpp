@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace asiochan
+{
+    // Locks usable for the state of a channel. Channels are locked together with other
+    // locks in std::scoped_lock, so try_lock is required as well.
+    // clang-format off
+    template <typename T>
+    concept channel_mutex = std::default_initializable<T> and requires (T& mutex)
+    {
+        mutex.lock();
+        mutex.unlock();
+        { mutex.try_lock() } -> std::convertible_to<bool>;
+    };
+    // clang-format on
+
+    // For channels that are only used from a single thread, e.g. within a strand or a
+    // single threaded io_context. Locking does nothing.
+    class null_mutex
+    {
+      public:
+        static void lock() noexcept { }
+
+        static void unlock() noexcept { }
+
+        [[nodiscard]] static auto try_lock() noexcept -> bool
+        {
+            return true;
+        }
+    };
+
+    namespace detail
+    {
+        inline void cpu_relax() noexcept
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+    }  // namespace detail
+
+    // A spinlock for the short critical sections of channel operations. Waiting threads
+    // spin with exponential backoff, and yield once the backoff reached its limit.
+    class spin_mutex
+    {
+      public:
+        void lock() noexcept
+        {
+            auto backoff = 1u;
+            while (locked_.exchange(true, std::memory_order_acquire))
+            {
+                // Wait until the lock looks free, without writing to its cache line.
+                while (locked_.load(std::memory_order_relaxed))
+                {
+                    if (backoff <= max_backoff)
+                    {
+                        for (auto i = 0u; i < backoff; ++i)
+                        {
+                            detail::cpu_relax();
+                        }
+                        backoff *= 2;
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+
+        void unlock() noexcept
+        {
+            locked_.store(false, std::memory_order_release);
+        }
+
+        [[nodiscard]] auto try_lock() noexcept -> bool
+        {
+            return not locked_.load(std::memory_order_relaxed)
+                   and not locked_.exchange(true, std::memory_order_acquire);
+        }
+
+      private:
+        static constexpr auto max_backoff = 64u;
+
+        std::atomic_bool locked_ = false;
+    };
+}  // namespace asiochan
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "asiochan/channel_concepts.hpp"
+#include "asiochan/detail/channel_method_ops.hpp"
+
+namespace asiochan
+{
+    // A borrowed handle of a channel: it has the operations of the channel it was made
+    // from, but does not keep the channel alive, and copying it does not touch the
+    // reference count. Use it to pass a channel to coroutines and functions that are
+    // done with it before the owning handles are dropped.
+    template <any_channel_type Channel>
+    class channel_ref
+      : public detail::channel_method_ops<
+            typename Channel::send_type,
+            typename Channel::executor_type,
+            Channel::buff_size,
+            Channel::flags,
+            channel_ref<Channel>>
+    {
+      public:
+        using executor_type = typename Channel::executor_type;
+        using shared_state_type = typename Channel::shared_state_type;
+        using shared_state_ptr_type = shared_state_type*;
+        using send_type = typename Channel::send_type;
+
+        static constexpr auto flags = Channel::flags;
+        static constexpr auto buff_size = Channel::buff_size;
+        static constexpr auto borrowed = true;
+
+        // Implicit, so that a channel can be passed where a channel_ref is expected.
+        channel_ref(Channel const& channel) noexcept
+          : shared_state_{channel.shared_state_ptr().get()}
+        {
+        }
+
+        [[nodiscard]] auto shared_state() const noexcept -> shared_state_type&
+        {
+            return *shared_state_;
+        }
+
+        [[nodiscard]] auto shared_state_ptr() const noexcept -> const shared_state_ptr_type&
+        {
+            return shared_state_;
+        }
+
+        [[nodiscard]] friend auto operator==(channel_ref const& lhs, channel_ref const& rhs) noexcept -> bool = default;
+
+      private:
+        shared_state_type* shared_state_;
+    };
+}  // namespace asiochan
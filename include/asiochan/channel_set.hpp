@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_concepts.hpp"
+#include "asiochan/detail/channel_observer.hpp"
+
+namespace asiochan
+{
+    // A persistent set of channels that reports which of them have become readable,
+    // similar to an edge-triggered epoll set.
+    //
+    // A channel is reported once after a value was written to it; it is reported again
+    // only after it has been returned by wait_ready() and written to again. Readers should
+    // therefore drain a reported channel with try_read() before waiting again. Reports can
+    // be spurious if another reader consumed the values first.
+    //
+    // A channel can belong to a single set at a time; adding it to a second one, or
+    // observing it otherwise, throws std::logic_error. Copies of a set share its state;
+    // all channels are removed from the set when the last copy is destroyed.
+    template <asio::execution::executor Executor>
+    class basic_channel_set
+    {
+      public:
+        using executor_type = Executor;
+        using key_type = std::size_t;
+
+        basic_channel_set()
+          : state_{std::make_shared<state>()}
+        {
+        }
+
+        template <any_readable_channel_type Channel>
+        auto add(Channel const& channel) -> key_type
+        {
+            auto const lock = std::scoped_lock{state_->mutex};
+            auto const key = state_->next_key++;
+
+            auto entry = std::make_unique<registration<Channel>>(*state_, key, channel);
+            auto& added = *entry;
+            auto const it = state_->registrations.emplace(key, std::move(entry)).first;
+            try
+            {
+                added.attach();
+            }
+            catch (...)
+            {
+                state_->registrations.erase(it);
+                throw;
+            }
+
+            return key;
+        }
+
+        void remove(key_type const key)
+        {
+            auto const lock = std::scoped_lock{state_->mutex};
+            if (auto const it = state_->registrations.find(key); it != state_->registrations.end())
+            {
+                it->second->detach();
+                state_->registrations.erase(it);
+            }
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t
+        {
+            auto const lock = std::scoped_lock{state_->mutex};
+            return state_->registrations.size();
+        }
+
+        // Waits until at least one channel is reported, and returns all reported channels.
+        [[nodiscard]] auto wait_ready() const -> asio::awaitable<std::vector<key_type>, Executor>
+        {
+            return wait_ready(state_);
+        }
+
+        // Returns the reported channels without waiting.
+        [[nodiscard]] auto try_wait_ready() const -> std::vector<key_type>
+        {
+            auto keys = std::vector<key_type>{};
+            collect_ready(*state_, keys);
+
+            return keys;
+        }
+
+      private:
+        struct state;
+
+        // Holds the state by value, so the set may be destroyed while the wait is pending.
+        static auto wait_ready(std::shared_ptr<state> state) -> asio::awaitable<std::vector<key_type>, Executor>
+        {
+            auto keys = std::vector<key_type>{};
+
+            while (keys.empty())
+            {
+                keys.push_back(co_await state->ready.read());
+                collect_ready(*state, keys);
+            }
+
+            co_return keys;
+        }
+
+        class registration_base : public detail::channel_observer
+        {
+          public:
+            registration_base(state& owner, key_type const key) noexcept
+              : owner_{owner}
+              , key_{key}
+            {
+            }
+
+            virtual ~registration_base() noexcept = default;
+
+            virtual void attach() = 0;
+
+            virtual void detach() noexcept = 0;
+
+            void rearm() noexcept
+            {
+                armed_.store(true, std::memory_order_release);
+            }
+
+            void on_readable() noexcept override
+            {
+                if (armed_.exchange(false, std::memory_order_acq_rel))
+                {
+                    owner_.ready.write(key_);
+                }
+            }
+
+          private:
+            state& owner_;
+            key_type key_;
+            std::atomic_bool armed_ = true;
+        };
+
+        template <typename Channel>
+        class registration final : public registration_base
+        {
+          public:
+            registration(state& owner, key_type const key, Channel const& channel)
+              : registration_base{owner, key}
+              , channel_{channel}
+            {
+            }
+
+            void attach() override
+            {
+                auto& channel_state = *channel_.shared_state_ptr();
+                auto const lock = std::scoped_lock{channel_state.mutex()};
+                channel_state.set_observer(this);
+
+                if (channel_state.readable())
+                {
+                    this->on_readable();
+                }
+            }
+
+            void detach() noexcept override
+            {
+                auto& channel_state = *channel_.shared_state_ptr();
+                auto const lock = std::scoped_lock{channel_state.mutex()};
+                channel_state.set_observer(nullptr);
+            }
+
+          private:
+            Channel channel_;
+        };
+
+        struct state
+        {
+            std::mutex mutex;
+            key_type next_key = 0;
+            std::unordered_map<key_type, std::unique_ptr<registration_base>> registrations;
+            basic_channel<key_type, unbounded_channel_buff, channel_stream_mode::block_until_available, Executor> ready;
+
+            ~state() noexcept
+            {
+                for (auto& [key, entry] : registrations)
+                {
+                    entry->detach();
+                }
+            }
+        };
+
+        static void collect_ready(state& state, std::vector<key_type>& keys)
+        {
+            while (auto const key = state.ready.try_read())
+            {
+                keys.push_back(*key);
+            }
+
+            // Re-arm the reported channels, and drop the ones removed in the meantime.
+            auto const lock = std::scoped_lock{state.mutex};
+            std::erase_if(
+                keys,
+                [&](key_type const key)
+                {
+                    auto const it = state.registrations.find(key);
+                    if (it == state.registrations.end())
+                    {
+                        return true;
+                    }
+
+                    it->second->rearm();
+                    return false;
+                });
+        }
+
+        std::shared_ptr<state> state_;
+    };
+
+    using channel_set = basic_channel_set<asio::any_io_executor>;
+}  // namespace asiochan
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_buff_size.hpp"
+#include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/timing_wheel.hpp"
+#include "asiochan/sendable.hpp"
+
+namespace asiochan
+{
+    // A channel whose values become readable at a time given by the writer, e.g. for
+    // retries and scheduled jobs. Writes never wait.
+    //
+    // Pending values are kept in a hierarchical timing wheel with ticks of the given
+    // resolution, so a write is O(1) regardless of how many values are pending. A single
+    // timer, shared by all copies of the channel, runs while values are pending and moves
+    // due values to an unbounded channel, which reader() returns for use in a select.
+    //
+    // Values are delivered at the first tick at or after their time. Values due at the
+    // same tick may be delivered in any order.
+    // clang-format off
+    template <sendable T, asio::execution::executor Executor>
+    requires (not std::is_void_v<T>)
+    class basic_delay_channel
+    // clang-format on
+    {
+      public:
+        using executor_type = Executor;
+        using send_type = T;
+        using clock = std::chrono::steady_clock;
+        using reader_type = basic_read_channel<T, unbounded_channel_buff, channel_stream_mode::block_until_available, Executor>;
+
+        explicit basic_delay_channel(Executor const& executor, clock::duration const resolution = std::chrono::milliseconds{1})
+          : state_{std::make_shared<state>(executor, resolution)}
+        {
+        }
+
+        void write(T value, clock::duration const delay) const
+        {
+            write_at(std::move(value), clock::now() + delay);
+        }
+
+        void write_at(T value, clock::time_point const time) const
+        {
+            auto const lock = std::scoped_lock{state_->mutex};
+            auto const current_time = clock::now();
+            auto const now = state_->ticks_until(current_time);
+            auto& wheel = state_->wheel;
+            if (wheel.empty() and now > wheel.now())
+            {
+                wheel.skip_to(now);
+            }
+
+            // Round up, so that values are never delivered early.
+            auto const due = state_->ticks_until(time - clock::duration{1}) + 1;
+            if (time <= current_time or due <= now)
+            {
+                state_->output.write(std::move(value));
+                return;
+            }
+
+            wheel.insert(due, std::move(value));
+            if (not state_->armed_tick or due < *state_->armed_tick)
+            {
+                arm_timer(state_);
+            }
+        }
+
+        // The number of values that are not due yet.
+        [[nodiscard]] auto pending() const -> std::size_t
+        {
+            auto const lock = std::scoped_lock{state_->mutex};
+            return state_->wheel.size();
+        }
+
+        [[nodiscard]] auto try_read() const -> std::optional<T>
+        {
+            return state_->output.try_read();
+        }
+
+        [[nodiscard]] auto read() const -> asio::awaitable<T, Executor>
+        {
+            return state_->output.read();
+        }
+
+        // The channel of due values, for use in a select, e.g. ops::read(delayed.reader()).
+        [[nodiscard]] auto reader() const -> reader_type
+        {
+            return reader_type{state_->output};
+        }
+
+      private:
+        using timer_type = asio::basic_waitable_timer<clock, asio::wait_traits<clock>, Executor>;
+        using output_type = basic_channel<T, unbounded_channel_buff, channel_stream_mode::block_until_available, Executor>;
+
+        struct state
+        {
+            state(Executor const& executor, clock::duration const resolution)
+              : resolution{resolution},
+                timer{executor}
+            {
+            }
+
+            [[nodiscard]] auto ticks_until(clock::time_point const time) const noexcept -> std::uint64_t
+            {
+                return time <= epoch ? 0 : static_cast<std::uint64_t>((time - epoch) / resolution);
+            }
+
+            std::mutex mutex;
+            clock::time_point const epoch = clock::now();
+            clock::duration const resolution;
+            detail::timing_wheel<T> wheel;
+            timer_type timer;
+            // The tick the timer waits for, if it is running.
+            std::optional<std::uint64_t> armed_tick;
+            output_type output;
+        };
+
+        // Must be called with the mutex held.
+        static void arm_timer(std::shared_ptr<state> const& state)
+        {
+            auto const next = state->wheel.next_tick();
+            state->armed_tick = next;
+            if (not next)
+            {
+                return;
+            }
+
+            // Cancels a wait for a later tick.
+            state->timer.expires_at(state->epoch + state->resolution * static_cast<clock::rep>(*next));
+            state->timer.async_wait(
+                [state](system::error_code const error)
+                {
+                    if (error != asio::error::operation_aborted)
+                    {
+                        expire(state);
+                    }
+                });
+        }
+
+        // Delivers all values that are due, with a single lock of the output channel.
+        static void expire(std::shared_ptr<state> const& state)
+        {
+            auto const lock = std::scoped_lock{state->mutex};
+            auto due = std::vector<T>{};
+            state->wheel.advance(
+                state->ticks_until(clock::now()),
+                [&](T&& value) { due.push_back(std::move(value)); });
+
+            static_cast<void>(state->output.shared_state().write_ready(
+                due.size(),
+                [&](detail::send_slot<T>& slot, std::size_t const index)
+                {
+                    slot.write(std::move(due[index]));
+                }));
+
+            arm_timer(state);
+        }
+
+        std::shared_ptr<state> state_;
+    };
+
+    template <sendable T>
+    using delay_channel = basic_delay_channel<T, asio::any_io_executor>;
+}  // namespace asiochan
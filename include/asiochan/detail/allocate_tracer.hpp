@@ -1,12 +1,14 @@
 #pragma once
 
 #include <atomic>
-#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
+#include <cstdint>
+#include <functional>
 #include <mutex>
+#include <optional>
 #include <source_location>
 #include <unordered_map>
 #include <vector>
-#include <functional>
+#if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
 #include <algorithm>
 #include <ranges>
 #endif
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+namespace asiochan::detail
+{
+    // A fixed value rather than std::hardware_destructive_interference_size,
+    // which is allowed to differ between translation units.
+    inline constexpr std::size_t cache_line_size = 64;
+}  // namespace asiochan::detail
@@ -1,70 +1,347 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
 #include <queue>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 
+#include "asiochan/byte_budget.hpp"
 #include "asiochan/channel_buff_size.hpp"
+#include "asiochan/detail/cache_line.hpp"
 #include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/spill_queue.hpp"
 #include "asiochan/sendable.hpp"
 
 namespace asiochan::detail
 {
-    template <sendable T, channel_buff_size size, bool forget_oldest>
+    template <typename T>
+    struct raw_slot
+    {
+        alignas(T) std::byte bytes[sizeof(T)];
+
+        [[nodiscard]] auto get() noexcept -> T*
+        {
+            return std::launder(reinterpret_cast<T*>(bytes));
+        }
+    };
+
+    template <sendable T, channel_buff_size buff_size, bool forget_oldest>
     class channel_buffer
     {
       public:
+        // Storage is rounded up to a power of two so that ring indices can be masked.
+        static constexpr auto capacity = std::bit_ceil(buff_size);
+
+        static_assert(buff_size <= std::numeric_limits<channel_buff_size>::max() / 2, "The buff_size is too large");
+
+        channel_buffer() noexcept = default;
+
+        channel_buffer(channel_buffer const&) = delete;
+
+        auto operator=(channel_buffer const&) -> channel_buffer& = delete;
+
+        ~channel_buffer() noexcept
+        {
+            while (not empty())
+            {
+                pop_front();
+            }
+        }
+
         [[nodiscard]] auto empty() const noexcept -> bool
         {
             return count_ == 0;
         }
 
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return count_;
+        }
+
         [[nodiscard]] auto full() const noexcept -> bool
         {
-            return count_ == size;
+            return count_ == buff_size;
         }
 
         void enqueue(send_slot<T>& from) noexcept
         {
-            if constexpr(forget_oldest)
+            if constexpr (forget_oldest)
             {
                 if (full())
                 {
-                    transfer<true>(from, buff_[(head_ + count_) % size]);
-                    head_ = (head_ + 1) % size;
+                    pop_front();
                 }
-                else
+            }
+
+            assert(not full());
+            std::construct_at(element(head_ + count_), from.read());
+            ++count_;
+        }
+
+        void dequeue(send_slot<T>& to) noexcept
+        {
+            assert(not empty());
+            to.write(std::move(*element(head_)));
+            pop_front();
+        }
+
+      private:
+        static constexpr auto index_mask = capacity - 1;
+
+        [[nodiscard]] auto element(std::size_t const index) noexcept -> T*
+        {
+            return storage_[index & index_mask].get();
+        }
+
+        void pop_front() noexcept
+        {
+            std::destroy_at(element(head_));
+            head_ = (head_ + 1) & index_mask;
+            --count_;
+        }
+
+        std::size_t head_ = 0;
+        std::size_t count_ = 0;
+        // Keep the elements off the cache line holding the indices (and the channel mutex).
+        alignas(cache_line_size) std::array<raw_slot<T>, capacity> storage_;
+    };
+
+    // The capacity of a dynamic buffer, at construction or later.
+    inline void check_capacity(std::size_t const capacity)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument{"asiochan: the capacity of a dynamic channel must be positive"};
+        }
+    }
+
+    // clang-format off
+    template <sendable T, bool forget_oldest>
+    requires (not std::is_void_v<T>)
+    class channel_buffer<T, dynamic_channel_buff, forget_oldest>
+    // clang-format on
+    {
+      public:
+        explicit channel_buffer(std::size_t const capacity)
+        {
+            set_capacity(capacity);
+        }
+
+        channel_buffer(channel_buffer const&) = delete;
+
+        auto operator=(channel_buffer const&) -> channel_buffer& = delete;
+
+        ~channel_buffer() noexcept
+        {
+            while (not empty())
+            {
+                pop_front();
+            }
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return count_ == 0;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return count_;
+        }
+
+        [[nodiscard]] auto full() const noexcept -> bool
+        {
+            // The capacity may have been reduced below the current count.
+            return count_ >= capacity_;
+        }
+
+        [[nodiscard]] auto capacity() const noexcept -> std::size_t
+        {
+            return capacity_;
+        }
+
+        void set_capacity(std::size_t const capacity)
+        {
+            check_capacity(capacity);
+            if (capacity > index_mask_ + 1)
+            {
+                reallocate(std::bit_ceil(capacity));
+            }
+            capacity_ = capacity;
+
+            if constexpr (forget_oldest)
+            {
+                while (count_ > capacity_)
                 {
-                    transfer(from, buff_[(head_ + count_++) % size]);
+                    pop_front();
                 }
             }
-            else
+        }
+
+        void enqueue(send_slot<T>& from) noexcept
+        {
+            if constexpr (forget_oldest)
             {
-                assert(not full());
-                transfer(from, buff_[(head_ + count_++) % size]);
+                while (full())
+                {
+                    pop_front();
+                }
             }
+
+            assert(not full());
+            std::construct_at(element(head_ + count_), from.read());
+            ++count_;
         }
 
         void dequeue(send_slot<T>& to) noexcept
         {
             assert(not empty());
-            --count_;
-            transfer(buff_[std::exchange(head_, (head_ + 1) % size)], to);
+            to.write(std::move(*element(head_)));
+            pop_front();
         }
 
       private:
+        [[nodiscard]] auto element(std::size_t const index) noexcept -> T*
+        {
+            return storage_[index & index_mask_].get();
+        }
+
+        void pop_front() noexcept
+        {
+            std::destroy_at(element(head_));
+            head_ = (head_ + 1) & index_mask_;
+            --count_;
+        }
+
+        void reallocate(std::size_t const storage_size)
+        {
+            auto storage = std::unique_ptr<raw_slot<T>[]>{new raw_slot<T>[storage_size]};
+            for (auto i = std::size_t{0}; i < count_; ++i)
+            {
+                auto const from = element(head_ + i);
+                std::construct_at(storage[i].get(), std::move(*from));
+                std::destroy_at(from);
+            }
+
+            storage_ = std::move(storage);
+            head_ = 0;
+            index_mask_ = storage_size - 1;
+        }
+
         std::size_t head_ = 0;
         std::size_t count_ = 0;
-        std::array<send_slot<T>, size> buff_;
+        std::size_t capacity_ = 0;
+        std::size_t index_mask_ = std::numeric_limits<std::size_t>::max();
+        std::unique_ptr<raw_slot<T>[]> storage_;
     };
 
     // clang-format off
-    template <channel_buff_size size, bool forget_oldest>
-    requires (size > 0)
-    class channel_buffer<void, size, forget_oldest>
+    template <sendable T, bool forget_oldest>
+    requires (not std::is_void_v<T>)
+    class channel_buffer<T, budgeted_channel_buff, forget_oldest>
+    // clang-format on
+    {
+      public:
+        explicit channel_buffer(byte_budget<T> budget)
+          : limit_{budget.limit},
+            low_watermark_{budget.low_watermark.value_or(budget.limit)},
+            size_of_{std::move(budget.size_of)}
+        {
+            if (limit_ == 0 or low_watermark_ > limit_ or not size_of_)
+            {
+                throw std::invalid_argument{
+                    "asiochan::byte_budget: limit must be positive, low_watermark at most the limit, and size_of set"};
+            }
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return queue_.empty();
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return queue_.size();
+        }
+
+        [[nodiscard]] auto full() const noexcept -> bool
+        {
+            return blocked_;
+        }
+
+        [[nodiscard]] auto used_bytes() const noexcept -> std::size_t
+        {
+            return used_bytes_;
+        }
+
+        void enqueue(send_slot<T>& from)
+        {
+            auto value = from.read();
+            auto const bytes = size_of_(value);
+            queue_.push({std::move(value), bytes});
+            used_bytes_ += bytes;
+
+            if constexpr (forget_oldest)
+            {
+                // Keep at least the new value, even if it exceeds the budget by itself.
+                while (used_bytes_ > limit_ and queue_.size() > 1)
+                {
+                    pop_front();
+                }
+            }
+            else if (used_bytes_ >= limit_)
+            {
+                blocked_ = true;
+            }
+        }
+
+        void dequeue(send_slot<T>& to) noexcept
+        {
+            assert(not empty());
+            to.write(std::move(queue_.front().value));
+            pop_front();
+
+            if (blocked_ and used_bytes_ < low_watermark_)
+            {
+                blocked_ = false;
+            }
+        }
+
+      private:
+        struct entry
+        {
+            T value;
+            std::size_t bytes;
+        };
+
+        void pop_front() noexcept
+        {
+            used_bytes_ -= queue_.front().bytes;
+            queue_.pop();
+        }
+
+        std::queue<entry> queue_;
+        std::size_t used_bytes_ = 0;
+        std::size_t limit_;
+        std::size_t low_watermark_;
+        bool blocked_ = false;
+        std::function<std::size_t(T const&)> size_of_;
+    };
+
+    // clang-format off
+    template <channel_buff_size buff_size, bool forget_oldest>
+    requires (buff_size > 0 and not is_dynamic(buff_size) and not is_budgeted(buff_size))
+    class channel_buffer<void, buff_size, forget_oldest>
     // clang-format on
     {
       public:
@@ -73,11 +350,16 @@ namespace asiochan::detail
             return count_ == 0;
         }
 
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return count_;
+        }
+
         [[nodiscard]] auto full() const noexcept -> bool
         {
-            if constexpr (size != unbounded_channel_buff)
+            if constexpr (buff_size != unbounded_channel_buff)
             {
-                return count_ == size;
+                return count_ == buff_size;
             }
             else
             {
@@ -111,6 +393,72 @@ namespace asiochan::detail
         std::size_t count_ = 0;
     };
 
+    template <bool forget_oldest>
+    class channel_buffer<void, dynamic_channel_buff, forget_oldest>
+    {
+      public:
+        explicit channel_buffer(std::size_t const capacity)
+        {
+            set_capacity(capacity);
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return count_ == 0;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return count_;
+        }
+
+        [[nodiscard]] auto full() const noexcept -> bool
+        {
+            return count_ >= capacity_;
+        }
+
+        [[nodiscard]] auto capacity() const noexcept -> std::size_t
+        {
+            return capacity_;
+        }
+
+        void set_capacity(std::size_t const capacity)
+        {
+            check_capacity(capacity);
+            capacity_ = capacity;
+            if constexpr (forget_oldest)
+            {
+                count_ = std::min(count_, capacity_);
+            }
+        }
+
+        void enqueue(send_slot<void>& from) noexcept
+        {
+            if constexpr (forget_oldest)
+            {
+                if (not full())
+                {
+                    ++count_;
+                }
+            }
+            else
+            {
+                assert(not full());
+                ++count_;
+            }
+        }
+
+        void dequeue(send_slot<void>& to) noexcept
+        {
+            assert(not empty());
+            --count_;
+        }
+
+      private:
+        std::size_t count_ = 0;
+        std::size_t capacity_ = 0;
+    };
+
     template <sendable T, bool forget_oldest>
     class channel_buffer<T, 0, forget_oldest>
     {
@@ -120,6 +468,11 @@ namespace asiochan::detail
             return true;
         }
 
+        [[nodiscard]] static auto size() noexcept -> std::size_t
+        {
+            return 0;
+        }
+
         [[nodiscard]] auto full() const noexcept -> bool
         {
             return true;
@@ -136,6 +489,14 @@ namespace asiochan::detail
         }
     };
 
+#ifdef ASIOCHAN_HAS_SPILL
+    template <typename T>
+    struct spill_pointer
+    {
+        using type = std::unique_ptr<spill_queue<T>>;
+    };
+#endif
+
     // clang-format off
     template <sendable T, bool forget_oldest>
     requires (not std::is_void_v<T>)
@@ -143,9 +504,26 @@ namespace asiochan::detail
     // clang-format on
     {
       public:
+        channel_buffer() = default;
+
+#ifdef ASIOCHAN_HAS_SPILL
+        // clang-format off
+        explicit channel_buffer(spill_options options)
+        requires std::is_trivially_copyable_v<T>
+          : spill_{std::make_unique<spill_queue<T>>(std::move(options))}
+        // clang-format on
+        {
+        }
+#endif
+
         [[nodiscard]] auto empty() const noexcept -> bool
         {
-            return queue_.empty();
+            return queue_.empty() and spilled() == 0;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return queue_.size() + spilled();
         }
 
         [[nodiscard]] static auto full() noexcept -> bool
@@ -153,19 +531,97 @@ namespace asiochan::detail
             return false;
         }
 
+        // The number of values in spill files, behind those in memory.
+        [[nodiscard]] auto spilled() const noexcept -> std::size_t
+        {
+#ifdef ASIOCHAN_HAS_SPILL
+            if constexpr (can_spill)
+            {
+                if (spill_)
+                {
+                    return spill_->size();
+                }
+            }
+#endif
+            return 0;
+        }
+
         void enqueue(send_slot<T>& from)
         {
+#ifdef ASIOCHAN_HAS_SPILL
+            if constexpr (can_spill)
+            {
+                // Once values were spilled, later ones must queue behind them. The slot
+                // is only consumed once the value is stored, as push() may fail.
+                if (spill_ and (not spill_->empty() or queue_.size() >= spill_->memory_limit()))
+                {
+                    spill_->push(*from.value());
+                    static_cast<void>(from.read());
+                    return;
+                }
+            }
+#endif
             queue_.push(from.read());
         }
 
         void dequeue(send_slot<T>& to) noexcept
         {
             assert(not empty());
+#ifdef ASIOCHAN_HAS_SPILL
+            if constexpr (can_spill)
+            {
+                if (queue_.empty())
+                {
+                    to.write(spill_->pop());
+                    return;
+                }
+            }
+#endif
             to.write(std::move(queue_.front()));
             queue_.pop();
+#ifdef ASIOCHAN_HAS_SPILL
+            if constexpr (can_spill)
+            {
+                if (spill_)
+                {
+                    refill_from_spill();
+                }
+            }
+#endif
         }
 
       private:
+#ifdef ASIOCHAN_HAS_SPILL
+        // Moves spilled values back to memory as readers catch up, so that writes go to
+        // memory again once the spill is drained. Values stay spilled if that fails.
+        void refill_from_spill() noexcept
+        {
+            try
+            {
+                while (not spill_->empty() and queue_.size() < spill_->memory_limit())
+                {
+                    queue_.push(spill_->front());
+                    static_cast<void>(spill_->pop());
+                }
+            }
+            catch (std::bad_alloc const&)
+            {
+            }
+        }
+#endif
+
         std::queue<T> queue_;
+#ifdef ASIOCHAN_HAS_SPILL
+        static constexpr bool can_spill = std::is_trivially_copyable_v<T>;
+
+        struct no_spill
+        {
+        };
+
+        [[no_unique_address]] typename std::conditional_t<
+            can_spill,
+            spill_pointer<T>,
+            std::type_identity<no_spill>>::type spill_;
+#endif
     };
 }  // namespace asiochan::detail
@@ -1,19 +1,46 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <optional>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include "asiochan/asio.hpp"
 #include "asiochan/channel_buff_size.hpp"
 #include "asiochan/channel_concepts.hpp"
+#include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/single_op.hpp"
 #include "asiochan/nothing_op.hpp"
 #include "asiochan/read_op.hpp"
 #include "asiochan/select.hpp"
 #include "asiochan/sendable.hpp"
 #include "asiochan/write_op.hpp"
 
+namespace asiochan
+{
+    template <any_channel_type Channel>
+    class channel_ref;
+}  // namespace asiochan
+
 namespace asiochan::detail
 {
+    // A handle that operations store by value. Operations that outlive the call, like
+    // async_read, hold it together with an owning shared_state_ptr.
+    template <any_channel_type Channel>
+    [[nodiscard]] auto borrow(Channel const& channel) noexcept
+    {
+        if constexpr (borrowed_channel_type<Channel>)
+        {
+            return channel;
+        }
+        else
+        {
+            return channel_ref<Channel>{channel};
+        }
+    }
+
     template <sendable T,
               asio::execution::executor Executor,
               channel_buff_size buff_size,
@@ -51,14 +78,46 @@ namespace asiochan::detail
             return result.has_value();
         }
 
+        // Writes values from the front of the span to waiting readers and into free buffer
+        // space under a single lock, without waiting. The written values are moved from,
+        // and their number is returned.
+        // clang-format off
+        [[nodiscard]] auto try_write_many(std::span<T> const values) const -> std::size_t
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        // clang-format on
+        {
+            return derived().shared_state_ptr()->write_ready(
+                values.size(),
+                [&](send_slot<T>& slot, std::size_t const index)
+                {
+                    slot.write(std::move(values[index]));
+                });
+        }
+
         // clang-format off
         [[nodiscard]] auto read() const -> asio::awaitable<T, Executor>
         requires (flags_is_readable(flags))
         // clang-format on
         {
-            auto result = co_await select(ops::read(derived()));
+            return single_op<Executor>(
+                ops::read(derived()),
+                [](auto&& result) -> T { return std::move(result).get(); });
+        }
 
-            co_return std::move(result).template get_received<T>();
+        // Like read, but completes a completion token with the value, see async_select. The
+        // operation keeps the channel alive, so the handle may be dropped meanwhile.
+        // clang-format off
+        template <typename CompletionToken>
+        requires (flags_is_readable(flags))
+        auto async_read(CompletionToken&& token) const
+        // clang-format on
+        {
+            auto const channel = borrow(derived());
+            return async_select_with<void(T)>(
+                token,
+                [](auto&& result) -> T { return std::move(result).template get_received<T>(); },
+                derived().shared_state_ptr(),
+                ops::read(channel));
         }
 
         auto read_sync(interrupter_t & interrupter) const -> std::optional<T>
@@ -80,12 +139,61 @@ namespace asiochan::detail
             return *read_sync(interrupter);
         }
 
+        // Returns nullopt if no value arrived before the deadline.
+        template <typename Clock, typename Duration>
+        auto read_sync_until(std::chrono::time_point<Clock, Duration> const deadline) const -> std::optional<T>
+        requires (flags_is_readable(flags))
+        {
+            auto result = select_sync_until(deadline, ops::read(derived()));
+            if (!result)
+            {
+                return std::nullopt;
+            }
+
+            return std::move(*result).template get_received<T>();
+        }
+
+        template <typename Rep, typename Period>
+        auto read_sync_for(std::chrono::duration<Rep, Period> const timeout) const -> std::optional<T>
+        requires (flags_is_readable(flags))
+        {
+            return read_sync_until(std::chrono::steady_clock::now() + timeout);
+        }
+
         // clang-format off
         [[nodiscard]] auto write(T value) const -> asio::awaitable<void, Executor>
         requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
         // clang-format on
         {
-            co_await select(ops::write(std::move(value), derived()));
+            return single_op<Executor>(ops::write(std::move(value), derived()), [](auto&&) {});
+        }
+
+        // Like write, but completes a completion token, see async_select and async_read.
+        // clang-format off
+        template <typename CompletionToken>
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        auto async_write(T value, CompletionToken&& token) const
+        // clang-format on
+        {
+            auto const channel = borrow(derived());
+            return async_select_with<void()>(
+                token, [](auto&&) {}, derived().shared_state_ptr(), ops::write(std::move(value), channel));
+        }
+
+        // Writes all values in order, waiting only when no reader or buffer space is ready.
+        // clang-format off
+        [[nodiscard]] auto write_many(std::vector<T> values) const -> asio::awaitable<void, Executor>
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        // clang-format on
+        {
+            auto const all = std::span{values};
+            auto written = try_write_many(all);
+            while (written < all.size())
+            {
+                co_await write(std::move(all[written]));
+                ++written;
+                written += try_write_many(all.subspan(written));
+            }
         }
 
         bool write_sync(interrupter_t & interrupter, T value) const
@@ -101,6 +209,21 @@ namespace asiochan::detail
             write_sync(interrupter, std::move(value));
         }
 
+        // Returns false if the value was not written before the deadline.
+        template <typename Clock, typename Duration>
+        bool write_sync_until(std::chrono::time_point<Clock, Duration> const deadline, T value) const
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        {
+            return select_sync_until(deadline, ops::write(std::move(value), derived())).has_value();
+        }
+
+        template <typename Rep, typename Period>
+        bool write_sync_for(std::chrono::duration<Rep, Period> const timeout, T value) const
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        {
+            return write_sync_until(std::chrono::steady_clock::now() + timeout, std::move(value));
+        }
+
         // clang-format off
         void write(T value) const
         requires (flags_is_writable(flags) and (flags_is_forget_oldest(flags) or is_unbounded(buff_size)))
@@ -152,12 +275,32 @@ namespace asiochan::detail
             return result.has_value();
         }
 
+        // Performs up to count writes to waiting readers and into free buffer space under a
+        // single lock, without waiting. Returns the number performed.
+        // clang-format off
+        [[nodiscard]] auto try_write_many(std::size_t const count) const -> std::size_t
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        // clang-format on
+        {
+            return derived().shared_state_ptr()->write_ready(count, [](send_slot<void>&, std::size_t) {});
+        }
+
         // clang-format off
-        [[nodiscard]] auto read() const -> asio::awaitable<void>
+        [[nodiscard]] auto read() const -> asio::awaitable<void, Executor>
         requires (flags_is_readable(flags))
         // clang-format on
         {
-            co_await select(ops::read(derived()));
+            return single_op<Executor>(ops::read(derived()), [](auto&&) {});
+        }
+
+        // clang-format off
+        template <typename CompletionToken>
+        requires (flags_is_readable(flags))
+        auto async_read(CompletionToken&& token) const
+        // clang-format on
+        {
+            auto const channel = borrow(derived());
+            return async_select_with<void()>(token, [](auto&&) {}, derived().shared_state_ptr(), ops::read(channel));
         }
 
         bool read_sync(interrupter_t & interrupter) const
@@ -173,12 +316,51 @@ namespace asiochan::detail
             read_sync(interrupter);
         }
 
+        // Returns false if nothing arrived before the deadline.
+        template <typename Clock, typename Duration>
+        bool read_sync_until(std::chrono::time_point<Clock, Duration> const deadline) const
+        requires (flags_is_readable(flags))
+        {
+            return select_sync_until(deadline, ops::read(derived())).has_value();
+        }
+
+        template <typename Rep, typename Period>
+        bool read_sync_for(std::chrono::duration<Rep, Period> const timeout) const
+        requires (flags_is_readable(flags))
+        {
+            return read_sync_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        // clang-format off
+        [[nodiscard]] auto write() const -> asio::awaitable<void, Executor>
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        // clang-format on
+        {
+            return single_op<Executor>(ops::write(derived()), [](auto&&) {});
+        }
+
+        // clang-format off
+        template <typename CompletionToken>
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        auto async_write(CompletionToken&& token) const
+        // clang-format on
+        {
+            auto const channel = borrow(derived());
+            return async_select_with<void()>(token, [](auto&&) {}, derived().shared_state_ptr(), ops::write(channel));
+        }
+
         // clang-format off
-        [[nodiscard]] auto write() const -> asio::awaitable<void>
+        [[nodiscard]] auto write_many(std::size_t const count) const -> asio::awaitable<void, Executor>
         requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
         // clang-format on
         {
-            co_await select(ops::write(derived()));
+            auto written = try_write_many(count);
+            while (written < count)
+            {
+                co_await write();
+                ++written;
+                written += try_write_many(count - written);
+            }
         }
 
         bool write_sync(interrupter_t & interrupter) const
@@ -194,6 +376,21 @@ namespace asiochan::detail
             write_sync(interrupter);
         }
 
+        // Returns false if the write did not complete before the deadline.
+        template <typename Clock, typename Duration>
+        bool write_sync_until(std::chrono::time_point<Clock, Duration> const deadline) const
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        {
+            return select_sync_until(deadline, ops::write(derived())).has_value();
+        }
+
+        template <typename Rep, typename Period>
+        bool write_sync_for(std::chrono::duration<Rep, Period> const timeout) const
+        requires (flags_is_writable(flags) and !flags_is_forget_oldest(flags) and !is_unbounded(buff_size))
+        {
+            return write_sync_until(std::chrono::steady_clock::now() + timeout);
+        }
+
         // clang-format off
         void write() const
         requires (flags_is_writable(flags) and (flags_is_forget_oldest(flags) or is_unbounded(buff_size)))
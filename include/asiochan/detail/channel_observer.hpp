@@ -0,0 +1,18 @@
+#pragma once
+
+namespace asiochan::detail
+{
+    // Receives readiness events of a single channel.
+    // Callbacks are invoked with the channel mutex held, and must not block.
+    class channel_observer
+    {
+      public:
+        virtual void on_readable() noexcept = 0;
+
+        // Only reported by channels whose writes can wait.
+        virtual void on_writable() noexcept { }
+
+      protected:
+        ~channel_observer() noexcept = default;
+    };
+}  // namespace asiochan::detail
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "asiochan/channel_concepts.hpp"
 #include "asiochan/sendable.hpp"
 
@@ -10,7 +12,7 @@ namespace asiochan::detail
     {
       public:
         explicit channel_op_result_base(const channel_type<T> auto& channel)
-          : shared_state_{channel.shared_state_ptr().get()} { }
+          : shared_state_{std::to_address(channel.shared_state_ptr())} { }
 
         [[nodiscard]] static auto matches(any_channel_type auto const&) noexcept -> bool
         {
@@ -19,7 +21,7 @@ namespace asiochan::detail
 
         [[nodiscard]] auto matches(channel_type<T> auto const& channel) const noexcept -> bool
         {
-            return channel.shared_state_ptr().get() == shared_state_;
+            return std::to_address(channel.shared_state_ptr()) == shared_state_;
         }
 
       private:
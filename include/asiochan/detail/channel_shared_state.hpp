@@ -1,13 +1,21 @@
 #pragma once
 
+#include <concepts>
+#include <cstddef>
 #include <mutex>
+#include <stdexcept>
 #include <type_traits>
 
 #include "asiochan/asio.hpp"
 #include "asiochan/channel_buff_size.hpp"
+#include "asiochan/channel_mutex.hpp"
+#include "asiochan/detail/cache_line.hpp"
 #include "asiochan/detail/channel_buffer.hpp"
+#include "asiochan/detail/channel_observer.hpp"
 #include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/detail/intrusive_ptr.hpp"
 #include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/wakeup_batch.hpp"
 #include "asiochan/sendable.hpp"
 
 #ifdef ASIOCHAN_CH_ALLOCATE_TRACER
@@ -42,20 +50,35 @@ namespace asiochan::detail
         static constexpr bool write_never_waits = true;
     };
 
-    template <sendable T, asio::execution::executor Executor, channel_buff_size buff_size_, bool forget_oldest_>
-    class channel_shared_state
-      : public channel_shared_state_writer_list_base<T, Executor, buff_size_ != unbounded_channel_buff && !forget_oldest_>
+    // The state is aligned to a cache line so that independent channels never share one.
+    // The mutex, both waiter lists and the buffer indices are all guarded by the same lock
+    // and are kept together; buffered elements start on the following line.
+    //
+    // Channel handles count their references in the state itself. The count is not atomic
+    // with a null_mutex, since such channels are used from a single thread anyway.
+    template <sendable T,
+              asio::execution::executor Executor,
+              channel_buff_size buff_size_,
+              bool forget_oldest_,
+              channel_mutex Mutex = std::mutex>
+    class alignas(cache_line_size) channel_shared_state
+      : public intrusive_ref_count<not std::same_as<Mutex, null_mutex>>,
+        public channel_shared_state_writer_list_base<T, Executor, buff_size_ != unbounded_channel_buff && !forget_oldest_>
     {
       public:
-        using mutex_type = std::mutex;
+        using mutex_type = Mutex;
         using buffer_type = channel_buffer<T, buff_size_, forget_oldest_>;
         using reader_list_type = channel_waiter_list<T, Executor>;
 
+        template <typename... BufferArgs>
         channel_shared_state(
 #if defined(ASIOCHAN_CH_ALLOCATE_TRACER) && defined(ASIOCHAN_CH_ALLOCATE_TRACER_FULL)
-          const std::source_location & src_loc
+          const std::source_location & src_loc,
 #endif
-        ) noexcept(noexcept(channel_shared_state_writer_list_base<T, Executor, buff_size_ != unbounded_channel_buff>{}))
+          BufferArgs&&... buffer_args
+        ) noexcept(noexcept(channel_shared_state_writer_list_base<T, Executor, buff_size_ != unbounded_channel_buff>{})
+                   and std::is_nothrow_constructible_v<buffer_type, BufferArgs...>)
+          : buffer_{std::forward<BufferArgs>(buffer_args)...}
         {
 #ifdef ASIOCHAN_CH_ALLOCATE_TRACER
           allocate_tracer::ctor(
@@ -101,12 +124,233 @@ namespace asiochan::detail
             return mutex_;
         }
 
+        // Must be called with the mutex held. A channel has a single observer; setting
+        // another one while it is observed throws std::logic_error.
+        void set_observer(channel_observer* const observer)
+        {
+            if (observer != nullptr and observer_ != nullptr)
+            {
+                throw std::logic_error{"asiochan: the channel is already observed"};
+            }
+            observer_ = observer;
+        }
+
+        // Must be called with the mutex held, after a value became available to readers.
+        void notify_readable() noexcept
+        {
+            if (observer_)
+            {
+                observer_->on_readable();
+            }
+        }
+
+        // Must be called with the mutex held, after space became available to writers.
+        void notify_writable() noexcept
+        {
+            if (observer_)
+            {
+                observer_->on_writable();
+            }
+        }
+
+        // Must be called with the mutex held, after a value was taken from the buffer.
+        // Stores the values of waiting writers while there is space for them, and adds
+        // the writers to wakeups, to be woken after the mutex is released.
+        // clang-format off
+        void refill_from_writers(wakeup_batch<Executor>& wakeups)
+        requires (not channel_shared_state::write_never_waits)
+        // clang-format on
+        {
+            while (not buffer_.full())
+            {
+                auto const writer = this->writer_list().dequeue_first_available();
+                if (not writer)
+                {
+                    notify_writable();
+                    return;
+                }
+
+                buffer_.enqueue(*writer->slot);
+                wakeups.add(*writer);
+            }
+        }
+
+        // Must be called with the mutex held.
+        [[nodiscard]] auto readable() noexcept -> bool
+        {
+            if constexpr (buff_size_ != 0)
+            {
+                if (not buffer_.empty())
+                {
+                    return true;
+                }
+            }
+            if constexpr (not channel_shared_state::write_never_waits)
+            {
+                return not this->writer_list().empty();
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        // Must be called with the mutex held.
+        // clang-format off
+        [[nodiscard]] auto writable() noexcept -> bool
+        requires (not channel_shared_state::write_never_waits)
+        // clang-format on
+        {
+            if constexpr (buff_size_ != 0)
+            {
+                if (not buffer_.full())
+                {
+                    return true;
+                }
+            }
+
+            return not reader_list_.empty();
+        }
+
+        // Hands up to count values to waiting readers, then stores the rest in free buffer
+        // space, without waiting. fill_slot(slot, index) writes the value with that index.
+        // Returns how many values were taken. Readers are woken after the mutex is released.
+        template <std::invocable<send_slot<T>&, std::size_t> FillSlot>
+        auto write_ready(std::size_t const count, FillSlot fill_slot) -> std::size_t
+        {
+            auto wakeups = wakeup_batch<Executor>{};
+            auto const lock = std::scoped_lock{mutex_};
+            auto slot = send_slot<T>{};
+            auto written = std::size_t{0};
+
+            for (; written < count; ++written)
+            {
+                if (auto const reader = reader_list_.dequeue_first_available())
+                {
+                    fill_slot(slot, written);
+                    transfer(slot, *reader->slot);
+                    wakeups.add(*reader);
+                    continue;
+                }
+
+                if constexpr (buff_size_ != 0)
+                {
+                    if (not buffer_.full())
+                    {
+                        fill_slot(slot, written);
+                        buffer_.enqueue(slot);
+                        notify_readable();
+                        continue;
+                    }
+                }
+
+                break;
+            }
+
+            return written;
+        }
+
+        // clang-format off
+        [[nodiscard]] auto capacity() -> std::size_t
+        requires (is_dynamic(buff_size_))
+        // clang-format on
+        {
+            auto const lock = std::scoped_lock{mutex_};
+            return buffer_.capacity();
+        }
+
+        // clang-format off
+        void set_capacity(std::size_t const capacity)
+        requires (is_dynamic(buff_size_))
+        // clang-format on
+        {
+            auto wakeups = wakeup_batch<Executor>{};
+            auto const lock = std::scoped_lock{mutex_};
+            buffer_.set_capacity(capacity);
+
+            if constexpr (not channel_shared_state::write_never_waits)
+            {
+                // Move waiting writers into the space that was added.
+                while (not buffer_.full())
+                {
+                    auto const writer = this->writer_list().dequeue_first_available();
+                    if (not writer)
+                    {
+                        break;
+                    }
+
+                    buffer_.enqueue(*writer->slot);
+                    wakeups.add(*writer);
+                }
+
+                if (not buffer_.full())
+                {
+                    notify_writable();
+                }
+            }
+        }
+
       private:
         mutex_type mutex_;
         reader_list_type reader_list_;
+        channel_observer* observer_ = nullptr;
         [[no_unique_address]] buffer_type buffer_;
     };
 
+    enum class waiter_list_side
+    {
+        readers,
+        writers,
+    };
+
+    template <waiter_list_side side, typename SharedState>
+    [[nodiscard]] auto waiter_list_of(SharedState& state) noexcept -> auto&
+    {
+        if constexpr (side == waiter_list_side::readers)
+        {
+            return state.reader_list();
+        }
+        else
+        {
+            return state.writer_list();
+        }
+    }
+
+    // See select_waiter_unlinker.
+    template <typename SharedState, waiter_list_side side>
+    auto try_unlink_waiter(void* const channel_state, select_waiter_link& link, void const* const held_state) noexcept
+        -> bool
+    {
+        auto& state = *static_cast<SharedState*>(channel_state);
+        auto& node = static_cast<typename SharedState::reader_list_type::node_type&>(link);
+
+        if (&state == held_state)
+        {
+            waiter_list_of<side>(state).dequeue(node);
+            return true;
+        }
+
+        if (not state.mutex().try_lock())
+        {
+            return false;
+        }
+
+        waiter_list_of<side>(state).dequeue(node);
+        state.mutex().unlock();
+        return true;
+    }
+
+    // Enqueues the waiter node of a select, with the mutex of the state held.
+    template <waiter_list_side side, typename SharedState, sendable T, asio::execution::executor Executor>
+    void enqueue_waiter(SharedState& state, channel_waiter_list_node<T, Executor>& node)
+    {
+        auto& list = waiter_list_of<side>(state);
+        list.unlinker() = {&state, &try_unlink_waiter<SharedState, side>};
+        node.unlinker = &list.unlinker();
+        list.enqueue(node);
+        node.ctx->track_waiter(node);
+    }
+
     template <typename T, sendable SendType, asio::execution::executor Executor>
     struct is_channel_shared_state
       : std::false_type
@@ -115,9 +359,10 @@ namespace asiochan::detail
 
     template <sendable SendType,
               asio::execution::executor Executor,
-              channel_buff_size buff_size, bool forget_oldest>
+              channel_buff_size buff_size, bool forget_oldest,
+              channel_mutex Mutex>
     struct is_channel_shared_state<
-        channel_shared_state<SendType, Executor, buff_size, forget_oldest>,
+        channel_shared_state<SendType, Executor, buff_size, forget_oldest, Mutex>,
         SendType,
         Executor>
       : std::true_type
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
 #include <cstddef>
+#include <limits>
 #include <mutex>
+#include <utility>
 #include <condition_variable>
 #include <variant>
 
@@ -24,21 +27,58 @@ namespace asiochan::detail
     struct select_async_t {};
     inline constexpr select_async_t select_async_tag {};
 
+    struct select_callback_t {};
+    inline constexpr select_callback_t select_callback_tag {};
+
+    // Completes the wait of a select that calls a completion handler. Called like
+    // set_value of a promise, possibly with a channel mutex held.
+    struct select_callback
+    {
+        void* target = nullptr;
+        void (*complete)(void* target, select_waiter_token token) = nullptr;
+    };
+
+    struct select_waiter_link;
+
+    // Unlinks the nodes of one waiter list, see select_waiter_link.
+    struct select_waiter_unlinker
+    {
+        void* channel_state = nullptr;
+        // Unlinks the node unless its channel is locked by someone else. held_state is
+        // the channel state the caller has locked already.
+        bool (*try_unlink)(void* channel_state, select_waiter_link& link, void const* held_state) noexcept = nullptr;
+    };
+
+    // The part of a waiter node seen by its select. The nodes of a one-shot select are
+    // chained, so that whoever claims the select unlinks the others from their channels
+    // right away, instead of leaving them for later operations to skip.
+    struct select_waiter_link
+    {
+        select_waiter_link* next_in_select = nullptr;
+        select_waiter_unlinker const* unlinker = nullptr;
+    };
+
     template <asio::execution::executor Executor>
     struct select_wait_context
     {
-        using promise_t = std::variant<async_promise<select_waiter_token, Executor>, sync_promise<select_waiter_token>>;
+        using promise_t = std::variant<async_promise<select_waiter_token, Executor>, sync_promise<select_waiter_token>, select_callback>;
         using async_promise_t = async_promise<select_waiter_token, Executor>;
         using sync_promise_t = sync_promise<select_waiter_token>;
         promise_t promise;
 
         std::mutex mux;
         bool avail_flag = true;
+        // Cleared by a persistent selector, whose nodes stay registered after a wakeup,
+        // and for a single waiter, which has no others to unlink.
+        bool track_waiters = true;
+        std::atomic<select_waiter_link*> first_waiter = nullptr;
 
         select_wait_context(const select_sync_t &, interrupter_t & interrupter): promise(std::in_place_type<sync_promise_t>, interrupter) {}
 
         select_wait_context(const select_async_t &): promise(std::in_place_type<async_promise_t>) {}
 
+        select_wait_context(const select_callback_t &, select_callback callback): promise(std::in_place_type<select_callback>, callback) {}
+
         void set_token(select_waiter_token token)
         {
             std::visit(detail::overloaded{
@@ -50,6 +90,10 @@ namespace asiochan::detail
                 {
                     promise.set_value(token);
                 },
+                [&token](select_callback const& callback)
+                {
+                    callback.complete(callback.target, token);
+                },
             }, promise);
         }
 
@@ -72,6 +116,43 @@ namespace asiochan::detail
             return true;
         }
 
+        // Makes an async context claimable again, for reuse by a persistent selector.
+        void rearm(async_promise_t&& next_promise)
+        {
+            std::lock_guard g(mux);
+            get_async_promise() = std::move(next_promise);
+            avail_flag = true;
+        }
+
+        // Must be called with the channel of the node locked.
+        void track_waiter(select_waiter_link& link)
+        {
+            if (not track_waiters)
+            {
+                return;
+            }
+
+            // Only the select itself adds nodes, but it may be claimed meanwhile.
+            link.next_in_select = first_waiter.load(std::memory_order_relaxed);
+            while (not first_waiter.compare_exchange_weak(
+                link.next_in_select, &link, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // Must be called with mutex() and the channel of the claimed node locked, after
+        // claiming. Nodes on channels that are busy are left to the owner to remove.
+        void unlink_waiters(select_waiter_link const& claimed) noexcept
+        {
+            for (auto link = first_waiter.exchange(nullptr, std::memory_order_acquire); link; link = link->next_in_select)
+            {
+                if (link != &claimed)
+                {
+                    link->unlinker->try_unlink(link->unlinker->channel_state, *link, claimed.unlinker->channel_state);
+                }
+            }
+        }
+
         bool interrupted()
         {
 
@@ -106,28 +187,110 @@ namespace asiochan::detail
         return ctx.make_inavailable();
     }
 
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+    // Completes a cancelled wait. No operation uses this token.
+    inline constexpr auto select_cancelled_token = std::numeric_limits<select_waiter_token>::max();
+
+    // Completes the wait with select_cancelled_token when the slot is emitted, unless an
+    // operation claimed the context first. The slot must be cleared before the context
+    // is destroyed.
+    template <asio::execution::executor Executor>
+    void cancel_wait_on(asio::cancellation_slot slot, select_wait_context<Executor>& ctx)
+    {
+        if (slot.is_connected())
+        {
+            slot.assign(
+                [&ctx](asio::cancellation_type const)
+                {
+                    if (claim(ctx))
+                    {
+                        ctx.set_token(select_cancelled_token);
+                    }
+                });
+        }
+    }
+
+    // Clears the slot after a wait, and throws if the wait was cancelled.
+    inline void finish_cancellable_wait(asio::cancellation_slot slot, select_waiter_token const token)
+    {
+        if (slot.is_connected())
+        {
+            slot.clear();
+        }
+
+        if (token == select_cancelled_token)
+        {
+            throw system::system_error{asio::error::make_error_code(asio::error::operation_aborted)};
+        }
+    }
+#endif
+
     template <sendable T, asio::execution::executor Executor>
-    struct channel_waiter_list_node
+    struct channel_waiter_list_node : select_waiter_link
     {
         select_wait_context<Executor>* ctx = nullptr;
         send_slot<T>* slot = nullptr;
         select_waiter_token token = 0;
         channel_waiter_list_node* prev = nullptr;
         channel_waiter_list_node* next = nullptr;
+        // Whether the node is in a waiter list. Cleared under the context mutex when
+        // the node is popped, so the owner can check it under that mutex alone.
+        bool linked = false;
     };
 
+    // Whether a node kept from a previous wait is still registered in its waiter list.
+    template <sendable T, asio::execution::executor Executor>
+    auto still_linked(select_wait_context<Executor>& ctx, channel_waiter_list_node<T, Executor> const& node) -> bool
+    {
+        std::lock_guard g(ctx.mutex());
+        return node.linked;
+    }
+
     template <sendable T, asio::execution::executor Executor>
     void notify_waiter(channel_waiter_list_node<T, Executor>& waiter)
     {
         waiter.ctx->set_token(waiter.token);
     }
 
+#ifdef ASIOCHAN_CH_WAITER_STATS
+    // Counts of a waiter list, read and written with the channel mutex held.
+    struct channel_waiter_stats
+    {
+        std::size_t enqueued = 0;
+        // Popped and woken by an operation on the channel.
+        std::size_t woken = 0;
+        // Unlinked by their select, or by whoever claimed it.
+        std::size_t removed = 0;
+        // Popped by an operation on the channel after their select was claimed or
+        // interrupted elsewhere.
+        std::size_t skipped = 0;
+    };
+#endif
+
     template <sendable T, asio::execution::executor Executor>
     class channel_waiter_list
     {
       public:
         using node_type = channel_waiter_list_node<T, Executor>;
 
+        // Used by the nodes of selects in this list. Set with the channel mutex held.
+        [[nodiscard]] auto unlinker() noexcept -> select_waiter_unlinker&
+        {
+            return unlinker_;
+        }
+
+#ifdef ASIOCHAN_CH_WAITER_STATS
+        [[nodiscard]] auto stats() const noexcept -> channel_waiter_stats const&
+        {
+            return stats_;
+        }
+#endif
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return first_ == nullptr;
+        }
+
         void enqueue(node_type& node) noexcept
         {
             node.prev = last_;
@@ -143,6 +306,10 @@ namespace asiochan::detail
             }
 
             last_ = &node;
+            node.linked = true;
+#ifdef ASIOCHAN_CH_WAITER_STATS
+            ++stats_.enqueued;
+#endif
         }
 
         void dequeue(node_type& node) noexcept
@@ -173,11 +340,30 @@ namespace asiochan::detail
             {
                 node.next = nullptr;
             }
+#ifdef ASIOCHAN_CH_WAITER_STATS
+            if (node.linked)
+            {
+                ++stats_.removed;
+            }
+#endif
+            node.linked = false;
         }
 
         auto dequeue_first_available(
             std::same_as<select_wait_context<Executor>> auto&... contexts) noexcept
             -> node_type*
+        {
+            return dequeue_first_available_if([](node_type&) noexcept { return true; }, contexts...);
+        }
+
+        // Like dequeue_first_available, but claims the first available waiter only if
+        // ready(node) returns true. ready() runs with the context of the waiter locked,
+        // so the waiter cannot be claimed elsewhere meanwhile.
+        template <std::predicate<node_type&> Ready>
+        auto dequeue_first_available_if(
+            Ready ready,
+            std::same_as<select_wait_context<Executor>> auto&... contexts) noexcept
+            -> node_type*
         {
             while (first_)
             {
@@ -185,6 +371,7 @@ namespace asiochan::detail
 
                 auto const pop = [&]()
                 {
+                    node->linked = false;
                     first_ = node->next;
                     if (not first_)
                     {
@@ -204,16 +391,27 @@ namespace asiochan::detail
                     {
                         return nullptr;
                     }
+                    if (not ready(*node))
+                    {
+                        return nullptr;
+                    }
 
                     node->ctx->make_inavailable();
                     (contexts.make_inavailable(), ...);
 
                     pop();
+                    node->ctx->unlink_waiters(*node);
+#ifdef ASIOCHAN_CH_WAITER_STATS
+                    ++stats_.woken;
+#endif
 
                     return node;
                 }
 
                 pop();
+#ifdef ASIOCHAN_CH_WAITER_STATS
+                ++stats_.skipped;
+#endif
             }
 
             return nullptr;
@@ -233,5 +431,9 @@ namespace asiochan::detail
       private:
         node_type* first_ = nullptr;
         node_type* last_ = nullptr;
+        select_waiter_unlinker unlinker_;
+#ifdef ASIOCHAN_CH_WAITER_STATS
+        channel_waiter_stats stats_;
+#endif
     };
 }  // namespace asiochan::detail
@@ -0,0 +1,36 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace asiochan::detail
+{
+    // Futexes on words in memory shared between processes, so not FUTEX_PRIVATE_FLAG.
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+    // Sleeps while the word holds expected. May return spuriously.
+    inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t const expected) noexcept
+    {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+
+    inline void futex_wake(std::atomic<std::uint32_t>& word, int const count = 1) noexcept
+    {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+    }
+
+    inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept
+    {
+        futex_wake(word, INT_MAX);
+    }
+}  // namespace asiochan::detail
+
+#endif
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace asiochan::detail
+{
+    // A reference count embedded in the counted object. The non-atomic variant is for
+    // objects that are only ever shared within a single thread.
+    template <bool atomic>
+    class intrusive_ref_count
+    {
+      public:
+        intrusive_ref_count() noexcept = default;
+        intrusive_ref_count(intrusive_ref_count const&) = delete;
+        auto operator=(intrusive_ref_count const&) -> intrusive_ref_count& = delete;
+
+        void add_ref() noexcept
+        {
+            if constexpr (atomic)
+            {
+                count_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                ++count_;
+            }
+        }
+
+        // Returns true if this was the last reference.
+        [[nodiscard]] auto release_ref() noexcept -> bool
+        {
+            if constexpr (atomic)
+            {
+                return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            }
+            else
+            {
+                return --count_ == 0;
+            }
+        }
+
+        [[nodiscard]] auto use_count() const noexcept -> std::size_t
+        {
+            if constexpr (atomic)
+            {
+                return count_.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                return count_;
+            }
+        }
+
+      private:
+        std::conditional_t<atomic, std::atomic_size_t, std::size_t> count_ = 1;
+    };
+
+    // Owns a reference of an object counted by an intrusive_ref_count base, like a
+    // shared_ptr without a separate control block.
+    template <typename T>
+    class intrusive_ptr
+    {
+      public:
+        using element_type = T;
+
+        intrusive_ptr() noexcept = default;
+
+        intrusive_ptr(intrusive_ptr const& other) noexcept
+          : ptr_{other.ptr_}
+        {
+            if (ptr_)
+            {
+                ptr_->add_ref();
+            }
+        }
+
+        intrusive_ptr(intrusive_ptr&& other) noexcept
+          : ptr_{std::exchange(other.ptr_, nullptr)}
+        {
+        }
+
+        auto operator=(intrusive_ptr const& other) noexcept -> intrusive_ptr&
+        {
+            intrusive_ptr{other}.swap(*this);
+            return *this;
+        }
+
+        auto operator=(intrusive_ptr&& other) noexcept -> intrusive_ptr&
+        {
+            intrusive_ptr{std::move(other)}.swap(*this);
+            return *this;
+        }
+
+        ~intrusive_ptr() noexcept
+        {
+            if (ptr_ and ptr_->release_ref())
+            {
+                delete ptr_;
+            }
+        }
+
+        void swap(intrusive_ptr& other) noexcept
+        {
+            std::swap(ptr_, other.ptr_);
+        }
+
+        [[nodiscard]] auto get() const noexcept -> T*
+        {
+            return ptr_;
+        }
+
+        [[nodiscard]] auto operator->() const noexcept -> T*
+        {
+            return ptr_;
+        }
+
+        [[nodiscard]] auto operator*() const noexcept -> T&
+        {
+            return *ptr_;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return ptr_ != nullptr;
+        }
+
+        [[nodiscard]] auto use_count() const noexcept -> std::size_t
+        {
+            return ptr_ ? ptr_->use_count() : 0;
+        }
+
+        [[nodiscard]] friend auto operator==(intrusive_ptr const& lhs, intrusive_ptr const& rhs) noexcept -> bool
+        {
+            return lhs.ptr_ == rhs.ptr_;
+        }
+
+        template <typename U, typename... Args>
+        friend auto make_intrusive(Args&&... args) -> intrusive_ptr<U>;
+
+      private:
+        // Adopts the reference the object was created with.
+        explicit intrusive_ptr(T* const ptr) noexcept
+          : ptr_{ptr}
+        {
+        }
+
+        T* ptr_ = nullptr;
+    };
+
+    template <typename T, typename... Args>
+    [[nodiscard]] auto make_intrusive(Args&&... args) -> intrusive_ptr<T>
+    {
+        return intrusive_ptr<T>{new T(std::forward<Args>(args)...)};
+    }
+}  // namespace asiochan::detail
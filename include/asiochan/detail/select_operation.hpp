@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/detail/select_impl.hpp"
+#include "asiochan/detail/type_traits.hpp"
+#include "asiochan/select_concepts.hpp"
+#include "asiochan/select_result.hpp"
+
+namespace asiochan::detail
+{
+    // A select that completes a handler instead of resuming a coroutine, for the
+    // completion token based functions. finish turns the select_result into the
+    // arguments of the handler. keep is held until the handler is called, e.g. to keep
+    // the channels of the operations alive.
+    //
+    // If an operation is ready, the handler is posted right away and nothing is
+    // allocated. Otherwise the operation state is allocated with the allocator associated
+    // with the handler, and the executor associated with the handler is kept busy until
+    // the handler has run. Handlers without an associated executor run on asio's system
+    // executor, as channels have no executor object of their own.
+    // clang-format off
+    template <typename Handler, typename Finish, typename Keep, select_op... Ops>
+    requires waitable_selection<Ops...>
+    class select_operation
+    // clang-format on
+    {
+      public:
+        using executor_type = typename head_t<Ops...>::executor_type;
+        using result_type = select_result<Ops...>;
+
+        // Only for start().
+        select_operation(Handler&& handler, Finish&& finish, Keep&& keep, Ops&&... ops)
+          : handler_{std::move(handler)},
+            finish_{std::move(finish)},
+            keep_{std::move(keep)},
+            work_{asio::prefer(asio::get_associated_executor(handler_), asio::execution::outstanding_work.tracked)},
+            ops_{std::move(ops)...},
+            wait_ctx_{select_callback_tag, select_callback{this, &on_token}}
+        {
+            wait_ctx_.track_waiters = (Ops::num_alternatives + ...) > 1;
+        }
+
+        static void start(Handler handler, Finish finish, Keep keep, Ops... ops)
+        {
+            if (auto result = select_if_ready(ops...))
+            {
+                auto executor = asio::get_associated_executor(handler);
+                asio::post(
+                    std::move(executor),
+                    [handler = std::move(handler), finish = std::move(finish), result = std::move(*result)]() mutable
+                    {
+                        complete(std::move(handler), std::move(finish), std::move(result));
+                    });
+                return;
+            }
+
+            auto allocator = allocator_type{asio::get_associated_allocator(handler)};
+            auto const self = allocator_traits::allocate(allocator, 1);
+            try
+            {
+                allocator_traits::construct(
+                    allocator, self, std::move(handler), std::move(finish), std::move(keep), std::move(ops)...);
+            }
+            catch (...)
+            {
+                allocator_traits::deallocate(allocator, self, 1);
+                throw;
+            }
+
+            self->submit();
+        }
+
+      private:
+        using allocator_type = typename std::allocator_traits<
+            asio::associated_allocator_t<Handler>>::template rebind_alloc<select_operation>;
+        using allocator_traits = std::allocator_traits<allocator_type>;
+        using work_executor_type = std::decay_t<decltype(asio::prefer(
+            asio::get_associated_executor(std::declval<Handler const&>()),
+            asio::execution::outstanding_work.tracked))>;
+
+        // Like select_ready, but without an operation that is always ready.
+        [[nodiscard]] static auto select_if_ready(Ops&... ops) -> std::optional<result_type>
+        {
+            auto result = std::optional<result_type>{};
+
+            ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+             {
+                 ([&]<std::size_t channel_index>(auto& op, constant<channel_index>)
+                  {
+                      constexpr auto op_base_token = select_ops_base_tokens<Ops...>[channel_index];
+
+                      if (auto const ready_alternative = op.submit_if_ready())
+                      {
+                          result.emplace(op.get_result(*ready_alternative), op_base_token + *ready_alternative);
+
+                          return true;
+                      }
+
+                      return false;
+                  }(ops, constant<indices>{})
+                  or ...);
+             }(std::index_sequence_for<Ops...>{}));
+
+            return result;
+        }
+
+        static void complete(Handler&& handler, Finish&& finish, result_type&& result)
+        {
+            if constexpr (std::is_void_v<std::invoke_result_t<Finish, result_type>>)
+            {
+                finish(std::move(result));
+                std::move(handler)();
+            }
+            else
+            {
+                std::move(handler)(finish(std::move(result)));
+            }
+        }
+
+        // Called like the promise of a select, possibly with a channel mutex held.
+        static void on_token(void* const target, select_waiter_token const token)
+        {
+            auto const self = static_cast<select_operation*>(target);
+            asio::post(self->work_, [self, token]() { self->finish_wait(token); });
+        }
+
+        void submit()
+        {
+            auto ready_token = std::optional<std::size_t>{};
+
+            {
+                // Keeps finish_wait from running until all operations are submitted.
+                auto const submit_lock = std::scoped_lock{submit_mutex_};
+
+                ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+                 {
+                     ([&]<std::size_t channel_index>(auto& op, constant<channel_index>)
+                      {
+                          constexpr auto op_base_token = select_ops_base_tokens<Ops...>[channel_index];
+
+                          if (auto const ready_alternative = op.submit_with_wait(
+                                  wait_ctx_,
+                                  op_base_token,
+                                  std::get<channel_index>(wait_states_)))
+                          {
+                              ready_token = op_base_token + *ready_alternative;
+
+                              return true;
+                          }
+
+                          return false;
+                      }(std::get<indices>(ops_), constant<indices>{})
+                      or ...);
+                 }(std::index_sequence_for<Ops...>{}));
+            }
+
+            if (ready_token)
+            {
+                wait_ctx_.set_token(*ready_token);
+            }
+        }
+
+        // Runs on the executor of the handler.
+        void finish_wait(select_waiter_token const success_token)
+        {
+            auto result = std::optional<result_type>{};
+
+            {
+                auto const submit_lock = std::scoped_lock{submit_mutex_};
+
+                ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+                 {
+                     ([&]<select_op Op, std::size_t channel_index>(Op& op, constant<channel_index>)
+                      {
+                          constexpr auto op_base_token = select_ops_base_tokens<Ops...>[channel_index];
+
+                          auto successful_alternative = std::optional<std::size_t>{};
+
+                          if (success_token >= op_base_token
+                              and success_token < op_base_token + Op::num_alternatives)
+                          {
+                              successful_alternative = success_token - op_base_token;
+                              result.emplace(op.get_result(*successful_alternative), success_token);
+                          }
+
+                          op.clear_wait(successful_alternative, std::get<channel_index>(wait_states_));
+                      }(std::get<indices>(ops_), constant<indices>{}),
+                      ...);
+                 }(std::index_sequence_for<Ops...>{}));
+            }
+
+            assert(result.has_value());
+
+            // Free the state before the upcall, so the handler may start another operation.
+            auto handler = std::move(handler_);
+            auto finish = std::move(finish_);
+            auto allocator = allocator_type{asio::get_associated_allocator(handler)};
+            allocator_traits::destroy(allocator, this);
+            allocator_traits::deallocate(allocator, this, 1);
+
+            complete(std::move(handler), std::move(finish), std::move(*result));
+        }
+
+        Handler handler_;
+        Finish finish_;
+        [[no_unique_address]] Keep keep_;
+        work_executor_type work_;
+        std::tuple<Ops...> ops_;
+        std::tuple<typename Ops::wait_state_type...> wait_states_;
+        std::mutex submit_mutex_;
+        select_wait_context<executor_type> wait_ctx_;
+    };
+
+    // clang-format off
+    template <typename Signature, typename CompletionToken, typename Finish, typename Keep, select_op... Ops>
+    requires waitable_selection<Ops...>
+    auto async_select_with(CompletionToken& token, Finish finish, Keep keep, Ops... ops)
+    // clang-format on
+    {
+        return asio::async_initiate<CompletionToken, Signature>(
+            []<typename Handler>(Handler&& handler, Finish finish, Keep keep, Ops... ops)
+            {
+                select_operation<std::decay_t<Handler>, Finish, Keep, Ops...>::start(
+                    std::forward<Handler>(handler),
+                    std::move(finish),
+                    std::move(keep),
+                    std::move(ops)...);
+            },
+            token,
+            std::move(finish),
+            std::move(keep),
+            std::move(ops)...);
+    }
+}  // namespace asiochan::detail
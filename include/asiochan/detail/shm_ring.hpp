@@ -0,0 +1,255 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <type_traits>
+
+#include "asiochan/channel_mutex.hpp"
+#include "asiochan/detail/cache_line.hpp"
+#include "asiochan/detail/futex.hpp"
+
+namespace asiochan::detail
+{
+    // A bounded lock-free MPMC ring (after D. Vyukov) placed in memory shared between
+    // processes. Every cell carries a sequence number telling whether it is free for
+    // the write at a position, or holds the value for the read at a position.
+    //
+    // Blocked readers and writers park on a futex word per side. The other side bumps
+    // the word and wakes a sleeper only when someone is parked, so transfers between
+    // running processes make no syscalls.
+    // clang-format off
+    template <typename T, std::size_t capacity>
+    requires (std::is_trivially_copyable_v<T> and std::has_single_bit(capacity))
+    class shm_ring
+    // clang-format on
+    {
+      public:
+        static constexpr std::uint32_t layout_magic = 0x61636831;  // "ach1"
+
+        shm_ring() noexcept
+        {
+            for (auto pos = std::uint64_t{0}; pos < capacity; ++pos)
+            {
+                cells_[pos].seq.store(pos, std::memory_order_relaxed);
+            }
+            element_size_ = sizeof(T);
+            capacity_ = capacity;
+            magic_.store(layout_magic, std::memory_order_release);
+            futex_wake_all(magic_);
+        }
+
+        // Waits until the process that created the ring has initialised it, and checks that
+        // it was created for the same element type and capacity.
+        [[nodiscard]] auto wait_initialised() noexcept -> bool
+        {
+            while (true)
+            {
+                auto const magic = magic_.load(std::memory_order_acquire);
+                if (magic == layout_magic)
+                {
+                    return element_size_ == sizeof(T) and capacity_ == capacity;
+                }
+                if (magic != 0)
+                {
+                    return false;
+                }
+
+                futex_wait(magic_, 0);
+            }
+        }
+
+        [[nodiscard]] auto try_write(T const& value) noexcept -> bool
+        {
+            auto pos = head_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& cell = cells_[pos % capacity];
+                auto const seq = cell.seq.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::int64_t>(seq - pos);
+                if (diff == 0)
+                {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.bytes = std::bit_cast<bytes_type>(value);
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        wake(readers_);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // The cell still holds the value written a lap ago.
+                    return false;
+                }
+                else
+                {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        [[nodiscard]] auto try_read() noexcept -> std::optional<T>
+        {
+            auto pos = tail_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& cell = cells_[pos % capacity];
+                auto const seq = cell.seq.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::int64_t>(seq - (pos + 1));
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        auto const value = std::bit_cast<T>(cell.bytes);
+                        cell.seq.store(pos + capacity, std::memory_order_release);
+                        wake(writers_);
+                        return value;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // Nothing was written to the cell yet.
+                    return std::nullopt;
+                }
+                else
+                {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Whether the next read would find a value. Other readers may take it first.
+        [[nodiscard]] auto readable() const noexcept -> bool
+        {
+            auto const pos = tail_.load(std::memory_order_relaxed);
+            return cells_[pos % capacity].seq.load(std::memory_order_acquire) == pos + 1;
+        }
+
+        // Blocks until readable(), or stop became true and interrupt() was called.
+        [[nodiscard]] auto wait_readable(std::atomic_bool const& stop) noexcept -> bool
+        {
+            return park_until(readers_, stop, [&] { return readable(); });
+        }
+
+        // Blocks until a value was read, or stop became true and interrupt() was called.
+        [[nodiscard]] auto read_sync(std::atomic_bool const& stop) noexcept -> std::optional<T>
+        {
+            std::optional<T> value;
+            park_until(readers_, stop, [&] { return (value = try_read()).has_value(); });
+
+            return value;
+        }
+
+        // Whether the next write would find a free cell. Other writers may take it first.
+        [[nodiscard]] auto writable() const noexcept -> bool
+        {
+            auto const pos = head_.load(std::memory_order_relaxed);
+            return cells_[pos % capacity].seq.load(std::memory_order_acquire) == pos;
+        }
+
+        // Blocks until writable(), or stop became true and interrupt() was called.
+        [[nodiscard]] auto wait_writable(std::atomic_bool const& stop) noexcept -> bool
+        {
+            return park_until(writers_, stop, [&] { return writable(); });
+        }
+
+        // Blocks until the value was written, or stop became true and interrupt() was called.
+        [[nodiscard]] auto write_sync(T const& value, std::atomic_bool const& stop) noexcept -> bool
+        {
+            return park_until(writers_, stop, [&] { return try_write(value); });
+        }
+
+        // Wakes every parked reader and writer of every process, to check their stop flag.
+        void interrupt() noexcept
+        {
+            for (auto* side : {&readers_, &writers_})
+            {
+                side->seq.fetch_add(1, std::memory_order_release);
+                futex_wake_all(side->seq);
+            }
+        }
+
+      private:
+        using bytes_type = std::array<std::byte, sizeof(T)>;
+
+        struct alignas(cache_line_size) side_type
+        {
+            std::atomic<std::uint32_t> seq = 0;
+            std::atomic<std::uint32_t> parked = 0;
+        };
+
+        struct cell_type
+        {
+            std::atomic<std::uint64_t> seq;
+            bytes_type bytes;
+        };
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+        static constexpr auto spin_limit = 64u;
+
+        static void wake(side_type& side) noexcept
+        {
+            // Pairs with the increment of parked before the last attempt in park_until.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (side.parked.load(std::memory_order_relaxed) != 0)
+            {
+                side.seq.fetch_add(1, std::memory_order_release);
+                futex_wake(side.seq);
+            }
+        }
+
+        template <typename Attempt>
+        static auto park_until(side_type& side, std::atomic_bool const& stop, Attempt attempt) noexcept -> bool
+        {
+            for (auto spins = 0u; spins < spin_limit; ++spins)
+            {
+                if (attempt())
+                {
+                    return true;
+                }
+                cpu_relax();
+            }
+
+            while (true)
+            {
+                auto const seq = side.seq.load(std::memory_order_acquire);
+                side.parked.fetch_add(1, std::memory_order_seq_cst);
+                auto const done = attempt();
+                if (not done and not stop.load(std::memory_order_acquire))
+                {
+                    futex_wait(side.seq, seq);
+                }
+                side.parked.fetch_sub(1, std::memory_order_relaxed);
+
+                if (done)
+                {
+                    return true;
+                }
+                if (stop.load(std::memory_order_acquire))
+                {
+                    return false;
+                }
+            }
+        }
+
+        std::atomic<std::uint32_t> magic_ = 0;
+        std::uint32_t element_size_ = 0;
+        std::uint64_t capacity_ = 0;
+
+        alignas(cache_line_size) std::atomic<std::uint64_t> head_ = 0;
+        alignas(cache_line_size) std::atomic<std::uint64_t> tail_ = 0;
+        side_type readers_;
+        side_type writers_;
+        alignas(cache_line_size) std::array<cell_type, capacity> cells_;
+    };
+}  // namespace asiochan::detail
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/async_promise.hpp"
+#include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/select_concepts.hpp"
+
+namespace asiochan::detail
+{
+    // Performs a single channel operation, like select with one operation but without
+    // its bookkeeping: an operation that is ready completes without suspending, and one
+    // that has to wait is the only waiter of its context. With a single channel, the
+    // submission touches nothing of the wait once the waiter is enqueued and the channel
+    // unlocked, so unlike select it needs no mutex against an early wakeup.
+    //
+    // finish is applied to the result of the operation, to produce the awaited value.
+    // clang-format off
+    template <asio::execution::executor Executor, select_op Op, typename Finish>
+    requires (Op::num_alternatives == 1 and not Op::always_waitfree)
+    [[nodiscard]] auto single_op(Op op, Finish finish)
+        -> asio::awaitable<std::invoke_result_t<Finish, typename Op::result_type>, Executor>
+    // clang-format on
+    {
+        if (op.submit_if_ready())
+        {
+            co_return finish(op.get_result(0));
+        }
+
+        auto wait_ctx = select_wait_context<Executor>{select_async_tag};
+        wait_ctx.track_waiters = false;
+        auto wait_state = typename Op::wait_state_type{};
+
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+        auto const cancellation_slot = (co_await asio::this_coro::cancellation_state).slot();
+        cancel_wait_on(cancellation_slot, wait_ctx);
+#endif
+
+        auto const token = co_await suspend_with_promise<select_waiter_token, Executor>(
+            [](async_promise<select_waiter_token, Executor>&& promise,
+               Op* const op,
+               select_wait_context<Executor>* const wait_ctx,
+               typename Op::wait_state_type* const wait_state)
+            {
+                wait_ctx->promise = std::move(promise);
+                if (auto const ready_alternative = op->submit_with_wait(*wait_ctx, 0, *wait_state))
+                {
+                    wait_ctx->set_token(*ready_alternative);
+                }
+            },
+            &op,
+            &wait_ctx,
+            &wait_state);
+
+        auto const succeeded = token == 0;
+        op.clear_wait(succeeded ? std::optional<std::size_t>{0} : std::nullopt, wait_state);
+
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+        finish_cancellable_wait(cancellation_slot, token);
+#endif
+
+        assert(succeeded);
+
+        co_return finish(op.get_result(0));
+    }
+}  // namespace asiochan::detail
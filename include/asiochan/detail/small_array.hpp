@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+#include "asiochan/detail/channel_buffer.hpp"
+
+namespace asiochan::detail
+{
+    // A runtime-sized array of default-constructed elements that does not allocate
+    // when it holds at most inline_capacity elements. Elements are never moved.
+    template <typename T, std::size_t inline_capacity>
+    class small_array
+    {
+      public:
+        small_array() noexcept = default;
+
+        small_array(small_array const&) = delete;
+
+        auto operator=(small_array const&) -> small_array& = delete;
+
+        ~small_array() noexcept
+        {
+            clear();
+        }
+
+        void reset(std::size_t const size)
+        {
+            clear();
+
+            if (size > inline_capacity)
+            {
+                heap_storage_.reset(new raw_slot<T>[size]);
+            }
+
+            for (; size_ < size; ++size_)
+            {
+                std::construct_at(storage()[size_].get());
+            }
+        }
+
+        void clear() noexcept
+        {
+            for (; size_ > 0; --size_)
+            {
+                std::destroy_at(storage()[size_ - 1].get());
+            }
+
+            heap_storage_.reset();
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return size_;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return size_ == 0;
+        }
+
+        [[nodiscard]] auto operator[](std::size_t const index) noexcept -> T&
+        {
+            assert(index < size_);
+            return *storage()[index].get();
+        }
+
+      private:
+        [[nodiscard]] auto storage() noexcept -> raw_slot<T>*
+        {
+            return heap_storage_ ? heap_storage_.get() : inline_storage_.data();
+        }
+
+        std::size_t size_ = 0;
+        std::unique_ptr<raw_slot<T>[]> heap_storage_;
+        std::array<raw_slot<T>, inline_capacity> inline_storage_;
+    };
+}  // namespace asiochan::detail
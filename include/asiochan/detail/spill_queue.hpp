@@ -0,0 +1,183 @@
+#pragma once
+
+#include "asiochan/spill_options.hpp"
+
+#ifdef ASIOCHAN_HAS_SPILL
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace asiochan::detail
+{
+    // A FIFO queue of values in memory-mapped files. Values are appended to the last
+    // segment file and read from the first one. A filled segment is dropped from memory
+    // until it is read; a segment that was read entirely is deleted.
+    // clang-format off
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    class spill_queue
+    // clang-format on
+    {
+      public:
+        explicit spill_queue(spill_options options)
+          : options_{std::move(options)}
+        {
+            assert(options_.memory_limit > 0 and options_.segment_size > 0);
+        }
+
+        spill_queue(spill_queue const&) = delete;
+        auto operator=(spill_queue const&) -> spill_queue& = delete;
+
+        ~spill_queue() noexcept
+        {
+            for (auto& segment : segments_)
+            {
+                close(segment);
+            }
+        }
+
+        [[nodiscard]] auto memory_limit() const noexcept -> std::size_t
+        {
+            return options_.memory_limit;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return size_ == 0;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return size_;
+        }
+
+        // Nothing is changed if a new segment cannot be created.
+        void push(T const& value)
+        {
+            if (segments_.empty() or segments_.back().written == options_.segment_size)
+            {
+                auto const added = open();
+                try
+                {
+                    segments_.push_back(added);
+                }
+                catch (...)
+                {
+                    close(added);
+                    throw;
+                }
+
+                if (segments_.size() > 1)
+                {
+                    page_out(segments_[segments_.size() - 2]);
+                }
+            }
+
+            auto& segment = segments_.back();
+            std::memcpy(segment.data + segment.written * sizeof(T), &value, sizeof(T));
+            ++segment.written;
+            ++size_;
+        }
+
+        [[nodiscard]] auto front() const noexcept -> T
+        {
+            assert(not empty());
+
+            auto const& segment = segments_.front();
+            auto bytes = std::array<std::byte, sizeof(T)>{};
+            std::memcpy(bytes.data(), segment.data + segment.read * sizeof(T), sizeof(T));
+
+            return std::bit_cast<T>(bytes);
+        }
+
+        [[nodiscard]] auto pop() noexcept -> T
+        {
+            auto const value = front();
+            auto& segment = segments_.front();
+            ++segment.read;
+            --size_;
+
+            if (segment.read == options_.segment_size or empty())
+            {
+                close(segment);
+                segments_.pop_front();
+            }
+
+            return value;
+        }
+
+      private:
+        struct segment_type
+        {
+            int fd = -1;
+            std::byte* data = nullptr;
+            std::size_t written = 0;
+            std::size_t read = 0;
+        };
+
+        [[nodiscard]] auto segment_bytes() const noexcept -> std::size_t
+        {
+            return options_.segment_size * sizeof(T);
+        }
+
+        [[nodiscard]] auto open() const -> segment_type
+        {
+            auto path = (options_.directory / "asiochan-spill-XXXXXX").string();
+            auto segment = segment_type{};
+            segment.fd = ::mkstemp(path.data());
+            if (segment.fd < 0)
+            {
+                throw std::system_error{errno, std::system_category(), "mkstemp"};
+            }
+            ::unlink(path.c_str());
+
+            if (::ftruncate(segment.fd, static_cast<off_t>(segment_bytes())) != 0)
+            {
+                auto const error = errno;
+                ::close(segment.fd);
+                throw std::system_error{error, std::system_category(), "ftruncate"};
+            }
+
+            auto const mapping = ::mmap(nullptr, segment_bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                auto const error = errno;
+                ::close(segment.fd);
+                throw std::system_error{error, std::system_category(), "mmap"};
+            }
+            segment.data = static_cast<std::byte*>(mapping);
+
+            return segment;
+        }
+
+        // The values stay in the file; reading them faults the pages back in.
+        void page_out(segment_type const& segment) const noexcept
+        {
+            ::msync(segment.data, segment_bytes(), MS_ASYNC);
+            ::madvise(segment.data, segment_bytes(), MADV_DONTNEED);
+        }
+
+        void close(segment_type const& segment) const noexcept
+        {
+            ::munmap(segment.data, segment_bytes());
+            ::close(segment.fd);
+        }
+
+        spill_options options_;
+        std::deque<segment_type> segments_;
+        std::size_t size_ = 0;
+    };
+}  // namespace asiochan::detail
+
+#endif
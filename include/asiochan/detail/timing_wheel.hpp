@@ -0,0 +1,180 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace asiochan::detail
+{
+    // A hierarchical timing wheel of values due at integer ticks. Each level has 64
+    // slots; a value is stored at the level of the highest 6 bit group in which its due
+    // tick differs from now(), in the slot given by that group. When now() reaches the
+    // start of a slot of a higher level, its values are moved down to lower levels, so
+    // every value is moved at most once per level and inserting is O(1).
+    //
+    // The levels cover the block of 2^36 ticks that now() is in. Values due in a later
+    // block wait in an overflow list, and are inserted again when now() reaches the
+    // start of the next block.
+    template <typename T>
+    class timing_wheel
+    {
+      public:
+        static constexpr auto slot_bits = 6u;
+        static constexpr auto slot_count = std::size_t{1} << slot_bits;
+        static constexpr auto level_count = 6u;
+        static constexpr auto span_bits = slot_bits * level_count;
+
+        [[nodiscard]] auto now() const noexcept -> std::uint64_t
+        {
+            return now_;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return size_ == 0;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return size_;
+        }
+
+        // Moves the current tick forward while there is nothing to expire.
+        void skip_to(std::uint64_t const tick) noexcept
+        {
+            assert(empty() and tick >= now_);
+            now_ = tick;
+        }
+
+        void insert(std::uint64_t due, T value)
+        {
+            assert(due > now_);
+            ++size_;
+            if (((due ^ now_) >> span_bits) != 0)
+            {
+                overflow_.push_back({due, std::move(value)});
+                return;
+            }
+
+            auto const level = static_cast<unsigned>(std::bit_width(due ^ now_) - 1) / slot_bits;
+            slot(level, due).push_back({due, std::move(value)});
+        }
+
+        // The next tick at which advance() has values to expire or move down.
+        [[nodiscard]] auto next_tick() const noexcept -> std::optional<std::uint64_t>
+        {
+            for (auto level = 0u; level < level_count; ++level)
+            {
+                auto const shift = level * slot_bits;
+                auto const group_start = now_ >> (shift + slot_bits) << (shift + slot_bits);
+                for (auto index = ((now_ >> shift) & slot_mask) + 1; index < slot_count; ++index)
+                {
+                    // Lower levels always come first.
+                    if (not slots_[level][index].empty())
+                    {
+                        return group_start | (index << shift);
+                    }
+                }
+            }
+
+            if (not overflow_.empty())
+            {
+                return (now_ | span_mask) + 1;
+            }
+
+            return std::nullopt;
+        }
+
+        // Moves the current tick to target, calling expire(value) for every value due
+        // until then in the order of their ticks.
+        template <typename Expire>
+        void advance(std::uint64_t const target, Expire&& expire)
+        {
+            while (auto const next = next_tick())
+            {
+                if (*next > target)
+                {
+                    break;
+                }
+                now_ = *next;
+
+                if ((now_ & span_mask) == 0)
+                {
+                    auto entries = std::exchange(overflow_, {});
+                    size_ -= entries.size();
+                    for (auto& entry : entries)
+                    {
+                        if (entry.due == now_)
+                        {
+                            expire(std::move(entry.value));
+                        }
+                        else
+                        {
+                            insert(entry.due, std::move(entry.value));
+                        }
+                    }
+                }
+
+                for (auto level = level_count - 1; level > 0; --level)
+                {
+                    if ((now_ & ((std::uint64_t{1} << (level * slot_bits)) - 1)) != 0)
+                    {
+                        continue;
+                    }
+
+                    auto entries = std::exchange(slot(level, now_), {});
+                    size_ -= entries.size();
+                    for (auto& entry : entries)
+                    {
+                        if (entry.due == now_)
+                        {
+                            expire(std::move(entry.value));
+                        }
+                        else
+                        {
+                            insert(entry.due, std::move(entry.value));
+                        }
+                    }
+                }
+
+                auto entries = std::exchange(slot(0, now_), {});
+                size_ -= entries.size();
+                for (auto& entry : entries)
+                {
+                    assert(entry.due == now_);
+                    expire(std::move(entry.value));
+                }
+            }
+
+            if (target > now_)
+            {
+                now_ = target;
+            }
+        }
+
+      private:
+        static constexpr auto slot_mask = std::uint64_t{slot_count - 1};
+        static constexpr auto span_mask = (std::uint64_t{1} << span_bits) - 1;
+
+        struct entry
+        {
+            std::uint64_t due;
+            T value;
+        };
+
+        [[nodiscard]] auto slot(unsigned const level, std::uint64_t const tick) noexcept -> std::vector<entry>&
+        {
+            return slots_[level][(tick >> (level * slot_bits)) & slot_mask];
+        }
+
+        std::uint64_t now_ = 0;
+        std::size_t size_ = 0;
+        std::array<std::array<std::vector<entry>, slot_count>, level_count> slots_;
+        std::vector<entry> overflow_;
+    };
+}  // namespace asiochan::detail
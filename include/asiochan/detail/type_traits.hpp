@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <type_traits>
 
 namespace asiochan::detail
@@ -25,6 +26,19 @@ namespace asiochan::detail
     template <typename... Ts>
     using last_t = typename last<Ts...>::type;
 
+    template <typename T>
+    struct is_optional : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_optional<std::optional<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    inline constexpr auto is_optional_v = is_optional<T>::value;
+
     template <auto value_>
     struct constant
     {
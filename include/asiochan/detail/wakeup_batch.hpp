@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/async_promise.hpp"
+#include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/sendable.hpp"
+
+namespace asiochan::detail
+{
+    // Collects the wakeups of waiters claimed within a critical section, so they are
+    // delivered after the channel mutex is released. Coroutines on the same executor are
+    // resumed from a single posted handler.
+    //
+    // Declare the batch before the lock, so it is flushed after the lock is released.
+    // A single waiter is kept inline and woken like notify_waiter(), without allocating.
+    template <asio::execution::executor Executor>
+    class wakeup_batch
+    {
+      public:
+        wakeup_batch() = default;
+
+        wakeup_batch(wakeup_batch const&) = delete;
+        auto operator=(wakeup_batch const&) -> wakeup_batch& = delete;
+
+        ~wakeup_batch() noexcept
+        {
+            flush();
+        }
+
+        // The waiter must have been claimed.
+        template <sendable T>
+        void add(channel_waiter_list_node<T, Executor>& waiter)
+        {
+            if (not first_)
+            {
+                first_.emplace(waiter.ctx, waiter.token);
+                return;
+            }
+
+            more_.emplace_back(waiter.ctx, waiter.token);
+        }
+
+        void flush()
+        {
+            using async_promise_type = typename select_wait_context<Executor>::async_promise_t;
+            using handler_type = decltype(std::declval<async_promise_type&>().release_with_value(select_waiter_token{}));
+            using executor_type = decltype(std::declval<async_promise_type const&>().get_executor());
+
+            struct group
+            {
+                executor_type executor;
+                std::vector<handler_type> handlers;
+            };
+
+            if (not first_)
+            {
+                return;
+            }
+            if (more_.empty())
+            {
+                auto const [ctx, token] = *std::exchange(first_, std::nullopt);
+                ctx->set_token(token);
+                return;
+            }
+
+            more_.insert(more_.begin(), *std::exchange(first_, std::nullopt));
+            auto groups = std::vector<group>{};
+
+            for (auto const& [ctx, token] : more_)
+            {
+                if (not std::holds_alternative<async_promise_type>(ctx->promise))
+                {
+                    // Blocked threads and completion handlers are notified directly.
+                    ctx->set_token(token);
+                    continue;
+                }
+
+                auto& promise = ctx->get_async_promise();
+                auto executor = promise.get_executor();
+                auto handler = promise.release_with_value(token);
+
+                auto const same_executor = [&](group const& g) { return g.executor == executor; };
+                if (auto const it = std::find_if(groups.begin(), groups.end(), same_executor); it != groups.end())
+                {
+                    it->handlers.push_back(std::move(handler));
+                }
+                else
+                {
+                    auto& added = groups.emplace_back(std::move(executor));
+                    added.handlers.push_back(std::move(handler));
+                }
+            }
+
+            more_.clear();
+
+            for (auto& [executor, handlers] : groups)
+            {
+                if (handlers.size() == 1)
+                {
+                    asio::post(executor, std::move(handlers.front()));
+                    continue;
+                }
+
+                asio::post(
+                    executor,
+                    [handlers = std::move(handlers)]() mutable
+                    {
+                        for (auto& handler : handlers)
+                        {
+                            std::move(handler)();
+                        }
+                    });
+            }
+        }
+
+      private:
+        using waiter_type = std::pair<select_wait_context<Executor>*, select_waiter_token>;
+
+        std::optional<waiter_type> first_;
+        std::vector<waiter_type> more_;
+    };
+}  // namespace asiochan::detail
@@ -0,0 +1,691 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_buff_size.hpp"
+#include "asiochan/channel_concepts.hpp"
+#include "asiochan/detail/type_traits.hpp"
+#include "asiochan/read_op.hpp"
+#include "asiochan/select.hpp"
+
+namespace asiochan
+{
+    // A stream is a channel of std::optional<T>, where std::nullopt marks the end of the stream.
+    // clang-format off
+    template <typename T>
+    concept any_readable_stream_type
+        = any_readable_channel_type<T> and detail::is_optional_v<typename T::send_type>;
+
+    template <typename T>
+    concept any_writable_stream_type
+        = any_writable_channel_type<T> and detail::is_optional_v<typename T::send_type>;
+    // clang-format on
+
+    template <typename Stream>
+    using stream_value_t = typename Stream::send_type::value_type;
+
+    namespace detail
+    {
+        // Maximum number of values a stage takes from its input per suspension.
+        inline constexpr auto stage_batch_size = std::size_t{64};
+
+        template <typename In, typename Out>
+        concept connectable_streams
+            = any_readable_stream_type<In>
+              and any_writable_stream_type<Out>
+              and std::same_as<typename In::executor_type, typename Out::executor_type>;
+
+        // Waits for a value, then takes the values that are already available without
+        // suspending again. Returns false once the end of the stream was read.
+        template <any_readable_stream_type In>
+        auto read_stage_batch(In const& in, std::vector<stream_value_t<In>>& batch)
+            -> asio::awaitable<bool, typename In::executor_type>
+        {
+            batch.clear();
+
+            auto value = co_await in.read();
+            while (value.has_value())
+            {
+                batch.push_back(std::move(*value));
+                if (batch.size() == stage_batch_size)
+                {
+                    co_return true;
+                }
+
+                auto next = in.try_read();
+                if (not next.has_value())
+                {
+                    co_return true;
+                }
+
+                value = std::move(*next);
+            }
+
+            co_return false;
+        }
+
+        template <any_writable_stream_type Out>
+        auto write_stage(Out const& out, typename Out::send_type value)
+            -> asio::awaitable<void, typename Out::executor_type>
+        {
+            if constexpr (flags_is_forget_oldest(Out::flags) or is_unbounded(Out::buff_size))
+            {
+                out.write(std::move(value));
+            }
+            else
+            {
+                co_await out.write(std::move(value));
+            }
+        }
+
+        // Runs a stage that calls a user function. If the function throws, the output is
+        // ended before the exception is rethrown, so that later stages end as well.
+        template <any_writable_stream_type Out>
+        auto end_on_failure(Out out, asio::awaitable<void, typename Out::executor_type> stage)
+            -> asio::awaitable<void, typename Out::executor_type>
+        {
+            auto failure = std::exception_ptr{};
+            try
+            {
+                co_await std::move(stage);
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+            if (failure)
+            {
+                co_await write_stage(out, std::nullopt);
+                std::rethrow_exception(failure);
+            }
+        }
+
+        template <typename In, typename Out, typename Fn>
+        auto map_stage(In in, Out out, Fn fn) -> asio::awaitable<void, typename In::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<In>>{};
+            auto more = true;
+            while (more)
+            {
+                more = co_await read_stage_batch(in, batch);
+                for (auto& value : batch)
+                {
+                    co_await write_stage(out, std::invoke(fn, std::move(value)));
+                }
+            }
+
+            co_await write_stage(out, std::nullopt);
+        }
+
+        template <typename In, typename Out, typename Pred>
+        auto filter_stage(In in, Out out, Pred pred) -> asio::awaitable<void, typename In::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<In>>{};
+            auto more = true;
+            while (more)
+            {
+                more = co_await read_stage_batch(in, batch);
+                for (auto& value : batch)
+                {
+                    if (std::invoke(pred, std::as_const(value)))
+                    {
+                        co_await write_stage(out, std::move(value));
+                    }
+                }
+            }
+
+            co_await write_stage(out, std::nullopt);
+        }
+
+        template <typename In, typename Out, typename Fn>
+        auto flat_map_stage(In in, Out out, Fn fn) -> asio::awaitable<void, typename In::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<In>>{};
+            auto more = true;
+            while (more)
+            {
+                more = co_await read_stage_batch(in, batch);
+                for (auto& value : batch)
+                {
+                    for (auto&& element : std::invoke(fn, std::move(value)))
+                    {
+                        co_await write_stage(out, std::forward<decltype(element)>(element));
+                    }
+                }
+            }
+
+            co_await write_stage(out, std::nullopt);
+        }
+
+        template <typename In, typename Out>
+        auto merge_stage(In in, Out out, std::shared_ptr<std::atomic_size_t> remaining)
+            -> asio::awaitable<void, typename In::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<In>>{};
+            auto more = true;
+            while (more)
+            {
+                more = co_await read_stage_batch(in, batch);
+                for (auto& value : batch)
+                {
+                    co_await write_stage(out, std::move(value));
+                }
+            }
+
+            // The last input to end ends the output.
+            if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                co_await write_stage(out, std::nullopt);
+            }
+        }
+
+        template <typename In, typename Out>
+        auto tee_stage(In in, std::vector<Out> outs) -> asio::awaitable<void, typename In::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<In>>{};
+            auto more = true;
+            while (more)
+            {
+                more = co_await read_stage_batch(in, batch);
+                for (auto const& value : batch)
+                {
+                    for (auto const& out : outs)
+                    {
+                        co_await write_stage(out, value);
+                    }
+                }
+            }
+
+            for (auto const& out : outs)
+            {
+                co_await write_stage(out, std::nullopt);
+            }
+        }
+
+        // Internal channels of parallel_map. Values are tagged with their position in the
+        // input stream, so the collector can restore the input order.
+        template <typename T, typename U, typename Executor>
+        struct parallel_map_channels
+        {
+            using task_channel = basic_channel<
+                std::optional<std::pair<std::size_t, T>>,
+                dynamic_channel_buff,
+                channel_stream_mode::block_until_available,
+                Executor>;
+            using result_channel = basic_channel<
+                std::optional<std::pair<std::size_t, U>>,
+                unbounded_channel_buff,
+                channel_stream_mode::block_until_available,
+                Executor>;
+            using credit_channel = basic_channel<
+                void,
+                dynamic_channel_buff,
+                channel_stream_mode::block_until_available,
+                Executor>;
+
+            task_channel tasks;
+            result_channel results;
+            // Bounds the values between the dispatcher and the collector.
+            credit_channel credits;
+            // Set by a worker whose function threw, before it ends its results.
+            std::shared_ptr<std::atomic_bool> failed = std::make_shared<std::atomic_bool>(false);
+        };
+
+        template <typename In, typename Channels>
+        auto parallel_map_dispatcher(In in, Channels channels, std::size_t const concurrency)
+            -> asio::awaitable<void, typename In::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<In>>{};
+            auto sequence = std::size_t{0};
+            auto more = true;
+            while (more)
+            {
+                more = co_await read_stage_batch(in, batch);
+                for (auto& value : batch)
+                {
+                    co_await channels.credits.read();
+                    co_await channels.tasks.write(std::pair{sequence++, std::move(value)});
+                }
+            }
+
+            for (auto i = std::size_t{0}; i < concurrency; ++i)
+            {
+                co_await channels.tasks.write(std::nullopt);
+            }
+        }
+
+        // Takes one task at a time, so that tasks already waiting go to idle workers.
+        template <typename Channels, typename Fn>
+        auto parallel_map_worker(Channels channels, Fn fn)
+            -> asio::awaitable<void, typename Channels::task_channel::executor_type>
+        {
+            auto failure = std::exception_ptr{};
+            try
+            {
+                while (auto task = co_await channels.tasks.read())
+                {
+                    auto& [sequence, value] = *task;
+                    channels.results.write(std::pair{sequence, std::invoke(fn, std::move(value))});
+                }
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+                channels.failed->store(true, std::memory_order_relaxed);
+            }
+
+            channels.results.write(std::nullopt);
+            if (failure)
+            {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        template <typename Channels, typename Out>
+        auto parallel_map_collector(
+            Channels channels,
+            Out out,
+            std::size_t const concurrency,
+            bool const preserve_order)
+            -> asio::awaitable<void, typename Out::executor_type>
+        {
+            auto batch = std::vector<stream_value_t<typename Channels::result_channel>>{};
+            auto pending = std::map<std::size_t, stream_value_t<Out>>{};
+            auto next_sequence = std::size_t{0};
+            auto finished_workers = std::size_t{0};
+
+            while (finished_workers != concurrency)
+            {
+                if (not co_await read_stage_batch(channels.results, batch))
+                {
+                    ++finished_workers;
+                    // The result of the failed task never arrives. End the output, and
+                    // let the dispatcher pass on the rest of the input to the workers
+                    // that are left, so that all coroutines of the stage complete.
+                    if (channels.failed->load(std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+
+                for (auto& [sequence, value] : batch)
+                {
+                    if (not preserve_order)
+                    {
+                        co_await write_stage(out, std::move(value));
+                        co_await channels.credits.write();
+                    }
+                    else
+                    {
+                        // Hold results back until all earlier ones have been written.
+                        pending.emplace(sequence, std::move(value));
+                        for (auto it = pending.begin(); it != pending.end() and it->first == next_sequence;
+                             it = pending.erase(it), ++next_sequence)
+                        {
+                            co_await write_stage(out, std::move(it->second));
+                            co_await channels.credits.write();
+                        }
+                    }
+                }
+            }
+
+            if (finished_workers == concurrency)
+            {
+                assert(pending.empty());
+                co_await write_stage(out, std::nullopt);
+                co_return;
+            }
+
+            co_await write_stage(out, std::nullopt);
+            while (channels.credits.try_write())
+            {
+            }
+            while (finished_workers != concurrency)
+            {
+                if (not co_await read_stage_batch(channels.results, batch))
+                {
+                    ++finished_workers;
+                }
+                for (auto i = std::size_t{0}; i < batch.size(); ++i)
+                {
+                    static_cast<void>(channels.credits.try_write());
+                }
+            }
+        }
+
+        // Placeholder for a batch stage without a channel of returned vectors.
+        struct no_batch_returns
+        {
+        };
+
+        struct batch_deadline
+        {
+            std::size_t generation;
+            std::chrono::steady_clock::time_point expiry;
+        };
+
+        // Owns the single timer of a batch stage. Deadlines only move forward, so waiting
+        // for the latest requested one at a time is enough; ticks of batches that were
+        // already flushed are ignored by the stage.
+        template <typename Deadlines, typename Ticks>
+        auto batch_timer(Deadlines deadlines, Ticks ticks) -> asio::awaitable<void, typename Ticks::executor_type>
+        {
+            using executor_type = typename Ticks::executor_type;
+            using clock = std::chrono::steady_clock;
+
+            auto timer = asio::basic_waitable_timer<clock, asio::wait_traits<clock>, executor_type>{
+                co_await asio::this_coro::executor};
+
+            while (auto const deadline = co_await deadlines.read())
+            {
+                timer.expires_at(deadline->expiry);
+                co_await timer.async_wait(asio::use_awaitable_t<executor_type>{});
+                ticks.write(deadline->generation);
+            }
+        }
+
+        template <typename In, typename Out, typename Returns>
+        auto batch_stage(
+            In in,
+            Out out,
+            Returns returns,
+            std::size_t const max_items,
+            std::chrono::steady_clock::duration const max_delay)
+            -> asio::awaitable<void, typename In::executor_type>
+        {
+            using executor_type = typename In::executor_type;
+            using batch_type = stream_value_t<Out>;
+
+            auto const deadlines = basic_channel<
+                std::optional<batch_deadline>,
+                1,
+                channel_stream_mode::forget_oldest,
+                executor_type>{};
+            auto const ticks = basic_channel<
+                std::size_t,
+                1,
+                channel_stream_mode::forget_oldest,
+                executor_type>{};
+            asio::co_spawn(co_await asio::this_coro::executor, batch_timer(deadlines, ticks), asio::detached);
+
+            auto const take_vector = [&]()
+            {
+                if constexpr (not std::same_as<Returns, no_batch_returns>)
+                {
+                    if (auto returned = returns.try_read())
+                    {
+                        returned->clear();
+                        return std::move(*returned);
+                    }
+                }
+
+                auto fresh = batch_type{};
+                fresh.reserve(max_items);
+                return fresh;
+            };
+
+            auto current = batch_type{};
+            auto generation = std::size_t{0};
+
+            auto const flush = [&]() -> asio::awaitable<void, executor_type>
+            {
+                ++generation;
+                co_await write_stage(out, std::move(current));
+                current = batch_type{};
+            };
+
+            while (true)
+            {
+                auto result = co_await select(ops::read(in), ops::read(ticks));
+
+                if (auto const tick = result.template get_if_received<std::size_t>())
+                {
+                    if (*tick == generation and not current.empty())
+                    {
+                        co_await flush();
+                    }
+                    continue;
+                }
+
+                auto value = std::move(result).template get_received<std::optional<stream_value_t<In>>>();
+                while (value.has_value())
+                {
+                    if (current.empty())
+                    {
+                        current = take_vector();
+                        deadlines.write(batch_deadline{generation, std::chrono::steady_clock::now() + max_delay});
+                    }
+
+                    current.push_back(std::move(*value));
+                    if (current.size() >= max_items)
+                    {
+                        co_await flush();
+                    }
+
+                    // Take what is already available before waiting again.
+                    auto next = in.try_read();
+                    if (not next.has_value())
+                    {
+                        break;
+                    }
+                    value = std::move(*next);
+                }
+
+                if (not value.has_value())
+                {
+                    break;
+                }
+            }
+
+            if (not current.empty())
+            {
+                co_await flush();
+            }
+            deadlines.write(std::nullopt);
+            co_await write_stage(out, std::nullopt);
+        }
+    }  // namespace detail
+
+    // Pipeline stages connecting streams. Each stage spawns its coroutines on the given
+    // executor, and ends its output stream after its input streams have ended.
+    // When a stage function throws, the stage ends its output early, so that later
+    // stages end as well. The exception is rethrown in the detached coroutine of the stage.
+    namespace stages
+    {
+        // Writes fn(value) for every value of the input.
+        // clang-format off
+        template <typename In, typename Out, typename Fn>
+        requires detail::connectable_streams<In, Out>
+                 and std::convertible_to<std::invoke_result_t<Fn&, stream_value_t<In>>, stream_value_t<Out>>
+        void map(typename In::executor_type const& executor, In in, Out out, Fn fn)
+        // clang-format on
+        {
+            asio::co_spawn(
+                executor,
+                detail::end_on_failure(out, detail::map_stage(std::move(in), out, std::move(fn))),
+                asio::detached);
+        }
+
+        // Writes the values of the input for which pred(value) is true.
+        // clang-format off
+        template <typename In, typename Out, typename Pred>
+        requires detail::connectable_streams<In, Out>
+                 and std::predicate<Pred&, stream_value_t<In> const&>
+                 and std::convertible_to<stream_value_t<In>, stream_value_t<Out>>
+        void filter(typename In::executor_type const& executor, In in, Out out, Pred pred)
+        // clang-format on
+        {
+            asio::co_spawn(
+                executor,
+                detail::end_on_failure(out, detail::filter_stage(std::move(in), out, std::move(pred))),
+                asio::detached);
+        }
+
+        // Writes every element of the range returned by fn(value), for every value of the input.
+        // clang-format off
+        template <typename In, typename Out, typename Fn>
+        requires detail::connectable_streams<In, Out>
+                 and std::ranges::input_range<std::invoke_result_t<Fn&, stream_value_t<In>>>
+                 and std::convertible_to<
+                         std::ranges::range_reference_t<std::invoke_result_t<Fn&, stream_value_t<In>>>,
+                         stream_value_t<Out>>
+        void flat_map(typename In::executor_type const& executor, In in, Out out, Fn fn)
+        // clang-format on
+        {
+            asio::co_spawn(
+                executor,
+                detail::end_on_failure(out, detail::flat_map_stage(std::move(in), out, std::move(fn))),
+                asio::detached);
+        }
+
+        // Like map, but runs up to concurrency calls of fn at the same time. With preserve_order,
+        // results are written in input order; otherwise as soon as they are available.
+        // At most 2 * concurrency values are in flight between the input and the output.
+        // clang-format off
+        template <typename In, typename Out, typename Fn>
+        requires detail::connectable_streams<In, Out>
+                 and std::copy_constructible<Fn>
+                 and std::convertible_to<std::invoke_result_t<Fn&, stream_value_t<In>>, stream_value_t<Out>>
+        void parallel_map(
+            typename In::executor_type const& executor,
+            In in,
+            Out out,
+            std::size_t const concurrency,
+            Fn fn,
+            bool const preserve_order = true)
+        // clang-format on
+        {
+            assert(concurrency > 0);
+
+            using channels_type = detail::parallel_map_channels<
+                stream_value_t<In>,
+                stream_value_t<Out>,
+                typename In::executor_type>;
+            auto const window = 2 * concurrency;
+            auto channels = channels_type{
+                typename channels_type::task_channel{concurrency},
+                typename channels_type::result_channel{},
+                typename channels_type::credit_channel{window},
+            };
+            for (auto i = std::size_t{0}; i < window; ++i)
+            {
+                [[maybe_unused]] auto const added = channels.credits.try_write();
+                assert(added);
+            }
+
+            for (auto i = std::size_t{0}; i < concurrency; ++i)
+            {
+                asio::co_spawn(executor, detail::parallel_map_worker(channels, fn), asio::detached);
+            }
+            asio::co_spawn(
+                executor,
+                detail::parallel_map_collector(channels, std::move(out), concurrency, preserve_order),
+                asio::detached);
+            asio::co_spawn(
+                executor,
+                detail::parallel_map_dispatcher(std::move(in), std::move(channels), concurrency),
+                asio::detached);
+        }
+
+        // Writes the values of all inputs to the output, in no particular order.
+        // The output ends after the last input has ended.
+        // clang-format off
+        template <std::ranges::input_range Ins,
+                  typename In = std::ranges::range_value_t<Ins>,
+                  typename Out>
+        requires detail::connectable_streams<In, Out>
+                 and std::convertible_to<stream_value_t<In>, stream_value_t<Out>>
+        void merge(typename In::executor_type const& executor, Ins&& ins, Out out)
+        // clang-format on
+        {
+            auto inputs = std::vector<In>(std::ranges::begin(ins), std::ranges::end(ins));
+            assert(not inputs.empty());
+
+            auto const remaining = std::make_shared<std::atomic_size_t>(inputs.size());
+            for (auto& in : inputs)
+            {
+                asio::co_spawn(executor, detail::merge_stage(std::move(in), out, remaining), asio::detached);
+            }
+        }
+
+        // Writes a copy of every value of the input to each output. The slowest output
+        // determines the pace of the stage.
+        // clang-format off
+        template <typename In,
+                  std::ranges::input_range Outs,
+                  typename Out = std::ranges::range_value_t<Outs>>
+        requires detail::connectable_streams<In, Out>
+                 and std::copy_constructible<stream_value_t<In>>
+                 and std::convertible_to<stream_value_t<In>, stream_value_t<Out>>
+        void tee(typename In::executor_type const& executor, In in, Outs&& outs)
+        // clang-format on
+        {
+            asio::co_spawn(
+                executor,
+                detail::tee_stage(std::move(in), std::vector<Out>(std::ranges::begin(outs), std::ranges::end(outs))),
+                asio::detached);
+        }
+
+        // Writes the values of the input in vectors of up to max_items values. A vector is
+        // written once it is full, or max_delay after its first value was read.
+        // clang-format off
+        template <typename In, typename Out>
+        requires detail::connectable_streams<In, Out>
+                 and std::same_as<stream_value_t<Out>, std::vector<stream_value_t<In>>>
+        void batch(
+            typename In::executor_type const& executor,
+            In in,
+            Out out,
+            std::size_t const max_items,
+            std::chrono::steady_clock::duration const max_delay)
+        // clang-format on
+        {
+            assert(max_items > 0);
+
+            asio::co_spawn(
+                executor,
+                detail::batch_stage(std::move(in), std::move(out), detail::no_batch_returns{}, max_items, max_delay),
+                asio::detached);
+        }
+
+        // Like batch, but reuses the vectors written to returns by the consumer, to keep
+        // their capacity. Returned vectors are cleared before reuse.
+        // clang-format off
+        template <typename In, typename Out, typename Returns>
+        requires detail::connectable_streams<In, Out>
+                 and std::same_as<stream_value_t<Out>, std::vector<stream_value_t<In>>>
+                 and readable_channel_type<Returns, std::vector<stream_value_t<In>>>
+                 and std::same_as<typename In::executor_type, typename Returns::executor_type>
+        void batch(
+            typename In::executor_type const& executor,
+            In in,
+            Out out,
+            std::size_t const max_items,
+            std::chrono::steady_clock::duration const max_delay,
+            Returns returns)
+        // clang-format on
+        {
+            assert(max_items > 0);
+
+            asio::co_spawn(
+                executor,
+                detail::batch_stage(std::move(in), std::move(out), std::move(returns), max_items, max_delay),
+                asio::detached);
+        }
+    }  // namespace stages
+}  // namespace asiochan
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_concepts.hpp"
+#include "asiochan/read_op.hpp"
+#include "asiochan/select.hpp"
+
+namespace asiochan
+{
+    // count reads per period, of which up to burst may follow each other without delay.
+    // All three must be positive. Rates above one read per clock tick are limited to one
+    // read per tick.
+    struct rate_limit
+    {
+        std::size_t count = 1;
+        std::chrono::steady_clock::duration period = std::chrono::seconds{1};
+        std::size_t burst = 1;
+    };
+
+    // Reads from a channel at most at the rate of a token bucket. Writers use the
+    // wrapped channel as before.
+    //
+    // Readers that find the bucket empty wait in FIFO order. A single timer per
+    // rate_limited (shared by its copies) runs while readers wait, and wakes as many of
+    // them at once as tokens have accrued by then. A token is taken before the read
+    // of the value, so readers that wait for values count against the rate as well.
+    // clang-format off
+    template <any_readable_channel_type Channel>
+    requires (not std::is_void_v<typename Channel::send_type>)
+    class rate_limited
+    // clang-format on
+    {
+      public:
+        using executor_type = typename Channel::executor_type;
+        using send_type = typename Channel::send_type;
+        using clock = std::chrono::steady_clock;
+
+        rate_limited(executor_type const& executor, Channel channel, rate_limit const limit)
+          : state_{std::make_shared<state>(executor, std::move(channel), limit)}
+        {
+        }
+
+        [[nodiscard]] auto channel() const noexcept -> Channel const&
+        {
+            return state_->channel;
+        }
+
+        // Reads a value if one is available and the rate allows it.
+        [[nodiscard]] auto try_read() const -> std::optional<send_type>
+        {
+            auto const lock = std::scoped_lock{state_->mutex};
+            auto const now = clock::now();
+            if (not state_->token_available(now))
+            {
+                return std::nullopt;
+            }
+
+            auto value = state_->channel.try_read();
+            if (value)
+            {
+                state_->take_tokens(now, 1);
+            }
+
+            return value;
+        }
+
+        [[nodiscard]] auto read() const -> asio::awaitable<send_type, executor_type>
+        {
+            return read(state_);
+        }
+
+      private:
+        using timer_type = asio::basic_waitable_timer<clock, asio::wait_traits<clock>, executor_type>;
+        using permit_channel_type
+            = basic_channel<void, unbounded_channel_buff, channel_stream_mode::block_until_available, executor_type>;
+
+        // The bucket is kept as the theoretical arrival time of the next read (GCRA): a
+        // token is available when it is at most (burst - 1) intervals ahead of now.
+        struct state
+        {
+            state(executor_type const& executor, Channel channel, rate_limit const limit)
+              : channel{std::move(channel)},
+                interval{interval_of(limit)},
+                tolerance{interval * static_cast<clock::rep>(limit.burst - 1)},
+                timer{executor}
+            {
+            }
+
+            // Never zero, which would divide by zero in available_tokens.
+            [[nodiscard]] static auto interval_of(rate_limit const& limit) -> clock::duration
+            {
+                if (limit.count == 0 or limit.burst == 0 or limit.period <= clock::duration::zero())
+                {
+                    throw std::invalid_argument{"asiochan::rate_limited: count, period and burst must be positive"};
+                }
+                if (limit.count >= static_cast<std::size_t>(limit.period.count()))
+                {
+                    return clock::duration{1};
+                }
+
+                return limit.period / static_cast<clock::rep>(limit.count);
+            }
+
+            // Must be called with the mutex held, like the following.
+            [[nodiscard]] auto token_available(clock::time_point const now) const noexcept -> bool
+            {
+                return waiting == 0 and available_tokens(now) > 0;
+            }
+
+            [[nodiscard]] auto available_tokens(clock::time_point const now) const noexcept -> std::size_t
+            {
+                auto const next = std::max(arrival, now);
+                if (next > now + tolerance)
+                {
+                    return 0;
+                }
+
+                return static_cast<std::size_t>((now + tolerance - next) / interval) + 1;
+            }
+
+            void take_tokens(clock::time_point const now, std::size_t const count) noexcept
+            {
+                arrival = std::max(arrival, now) + interval * static_cast<clock::rep>(count);
+            }
+
+            std::mutex mutex;
+            Channel channel;
+            clock::duration interval;
+            clock::duration tolerance;
+            clock::time_point arrival = clock::time_point::min();
+            // Readers that found the bucket empty, and were not granted a permit yet.
+            std::size_t waiting = 0;
+            bool timer_armed = false;
+            timer_type timer;
+            permit_channel_type permits;
+        };
+
+        static auto read(std::shared_ptr<state> state) -> asio::awaitable<send_type, executor_type>
+        {
+            if (not acquire(state))
+            {
+                co_await select(ops::read(state->permits));
+            }
+
+            co_return co_await state->channel.read();
+        }
+
+        // Takes a token, or queues the caller for a permit and makes sure the timer runs.
+        static auto acquire(std::shared_ptr<state> const& state) -> bool
+        {
+            auto const lock = std::scoped_lock{state->mutex};
+            auto const now = clock::now();
+            if (state->token_available(now))
+            {
+                state->take_tokens(now, 1);
+                return true;
+            }
+
+            ++state->waiting;
+            if (not state->timer_armed)
+            {
+                arm_timer(state);
+            }
+
+            return false;
+        }
+
+        // Must be called with the mutex held.
+        static void arm_timer(std::shared_ptr<state> const& state)
+        {
+            state->timer_armed = true;
+            state->timer.expires_at(state->arrival - state->tolerance);
+            state->timer.async_wait([state](system::error_code) { grant(state); });
+        }
+
+        // Hands out all tokens that accrued to waiting readers at once.
+        static void grant(std::shared_ptr<state> const& state)
+        {
+            auto const lock = std::scoped_lock{state->mutex};
+            auto const now = clock::now();
+            auto const count = std::min(state->available_tokens(now), state->waiting);
+            state->take_tokens(now, count);
+            state->waiting -= count;
+            static_cast<void>(state->permits.shared_state().write_ready(count, [](detail::send_slot<void>&, std::size_t) {}));
+
+            state->timer_armed = false;
+            if (state->waiting != 0)
+            {
+                arm_timer(state);
+            }
+        }
+
+        std::shared_ptr<state> state_;
+    };
+}  // namespace asiochan
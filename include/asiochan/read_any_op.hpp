@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel_concepts.hpp"
+#include "asiochan/detail/channel_shared_state.hpp"
+#include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/wakeup_batch.hpp"
+#include "asiochan/detail/small_array.hpp"
+#include "asiochan/read_op.hpp"
+#include "asiochan/select_concepts.hpp"
+#include "asiochan/sendable.hpp"
+
+namespace asiochan
+{
+    template <sendable T>
+    class read_any_result : public read_result<T>
+    {
+      private:
+        using base = read_result<T>;
+
+      public:
+        template <typename... Args>
+        explicit read_any_result(std::size_t const index, Args&&... args)
+          : base{std::forward<Args>(args)...}
+          , index_{index}
+        {
+        }
+
+        // Position of the channel the value was received from in the range.
+        [[nodiscard]] auto index() const noexcept -> std::size_t
+        {
+            return index_;
+        }
+
+      private:
+        std::size_t index_;
+    };
+
+    namespace ops
+    {
+        // Number of waiter nodes stored inline; larger ranges allocate once per wait.
+        inline constexpr auto read_any_inline_waiters = std::size_t{8};
+
+        // Largest number of channels in a range. Every channel is an alternative, so a
+        // select reserves a block of this many tokens for the operation.
+        inline constexpr auto read_any_max_channels = std::size_t{1} << 16;
+
+        // Waits on a runtime-sized range of channels of the same type.
+        // When several channels are ready, the one that comes first in the range wins.
+        template <sendable T, readable_channel_type<T> Channel>
+        class read_any
+        {
+          public:
+            using executor_type = typename Channel::executor_type;
+            using result_type = read_any_result<T>;
+            using slot_type = detail::send_slot<T>;
+            using waiter_node_type = detail::channel_waiter_list_node<T, executor_type>;
+
+            static constexpr auto num_alternatives = read_any_max_channels;
+            static constexpr auto always_waitfree = false;
+            static constexpr auto reusable = true;
+
+            struct wait_state_type
+            {
+                detail::small_array<waiter_node_type, read_any_inline_waiters> waiter_nodes = {};
+            };
+
+            // Throws std::invalid_argument for an empty range, and std::length_error for a
+            // range of more than read_any_max_channels channels.
+            explicit read_any(std::span<Channel> const channels)
+              : channels_{channels}
+            {
+                if (channels_.empty())
+                {
+                    throw std::invalid_argument{"asiochan::ops::read_any: empty range of channels"};
+                }
+                if (channels_.size() > num_alternatives)
+                {
+                    throw std::length_error{"asiochan::ops::read_any: too many channels"};
+                }
+            }
+
+            [[nodiscard]] auto submit_if_ready() const -> std::optional<std::size_t>
+            {
+                using shared_state_type = typename Channel::shared_state_type;
+
+                for (auto channel_index = std::size_t{0}; channel_index < channels_.size(); ++channel_index)
+                {
+                    auto const& channel_state = channels_[channel_index].shared_state_ptr();
+                    auto wakeups = detail::wakeup_batch<executor_type>{};
+                    auto const lock = std::scoped_lock{channel_state->mutex()};
+
+                    if constexpr (shared_state_type::buff_size != 0)
+                    {
+                        if (not channel_state->buffer().empty())
+                        {
+                            // Get a value from the buffer.
+                            channel_state->buffer().dequeue(slot_);
+
+                            if constexpr (not shared_state_type::write_never_waits)
+                            {
+                                // Wake writers that waited for space, oldest first.
+                                channel_state->refill_from_writers(wakeups);
+                            }
+
+                            return channel_index;
+                        }
+                    }
+                    else if (auto const writer = channel_state->writer_list().dequeue_first_available())
+                    {
+                        // Get a value directly from a waiting writer.
+                        transfer(*writer->slot, slot_);
+                        wakeups.add(*writer);
+
+                        return channel_index;
+                    }
+                }
+
+                return std::nullopt;
+            }
+
+            [[nodiscard]] auto submit_with_wait(
+                detail::select_wait_context<executor_type>& select_ctx,
+                detail::select_waiter_token const base_token,
+                wait_state_type& wait_state) const
+                -> std::optional<std::size_t>
+            {
+                using shared_state_type = typename Channel::shared_state_type;
+
+                assert(not channels_.empty());
+                if (wait_state.waiter_nodes.size() != channels_.size())
+                {
+                    wait_state.waiter_nodes.reset(channels_.size());
+                }
+
+                for (auto channel_index = std::size_t{0}; channel_index < channels_.size(); ++channel_index)
+                {
+                    if (auto const& kept_node = wait_state.waiter_nodes[channel_index];
+                        kept_node.ctx != nullptr and detail::still_linked(select_ctx, kept_node))
+                    {
+                        // Still registered from a previous wait, so no value arrived since.
+                        continue;
+                    }
+
+                    auto const& channel_state = channels_[channel_index].shared_state_ptr();
+                    auto wakeups = detail::wakeup_batch<executor_type>{};
+                    auto const lock = std::scoped_lock{channel_state->mutex()};
+
+                    if constexpr (shared_state_type::buff_size != 0)
+                    {
+                        if (not channel_state->buffer().empty())
+                        {
+                            if (not claim(select_ctx))
+                            {
+                                // A different waiting operation succeeded concurrently
+                                return std::nullopt;
+                            }
+
+                            // Get a value from the buffer.
+                            channel_state->buffer().dequeue(slot_);
+
+                            if constexpr (not shared_state_type::write_never_waits)
+                            {
+                                // Wake writers that waited for space, oldest first.
+                                channel_state->refill_from_writers(wakeups);
+                            }
+
+                            return channel_index;
+                        }
+                    }
+                    else if (auto const writer = channel_state->writer_list().dequeue_first_available(select_ctx))
+                    {
+                        // Get a value directly from a waiting writer.
+                        transfer(*writer->slot, slot_);
+                        wakeups.add(*writer);
+
+                        return channel_index;
+                    }
+                    else if (not channel_state->writer_list().empty())
+                    {
+                        // A different waiting operation succeeded concurrently
+                        return std::nullopt;
+                    }
+
+                    // Wait for a value.
+                    auto& waiter_node = wait_state.waiter_nodes[channel_index];
+                    waiter_node.ctx = &select_ctx;
+                    waiter_node.slot = &slot_;
+                    waiter_node.token = base_token + channel_index;
+                    waiter_node.next = nullptr;
+
+                    detail::enqueue_waiter<detail::waiter_list_side::readers>(*channel_state, waiter_node);
+                    channel_state->notify_writable();
+                }
+
+                return std::nullopt;
+            }
+
+            void clear_wait(
+                std::optional<std::size_t> const successful_alternative,
+                wait_state_type& wait_state) const
+            {
+                for (auto channel_index = std::size_t{0}; channel_index < wait_state.waiter_nodes.size(); ++channel_index)
+                {
+                    auto& waiter_node = wait_state.waiter_nodes[channel_index];
+
+                    if (channel_index == successful_alternative or waiter_node.ctx == nullptr
+                        or not detail::still_linked(*waiter_node.ctx, waiter_node))
+                    {
+                        // No need to clear wait on a successful, unsubmitted or already
+                        // unlinked sub-operation
+                        continue;
+                    }
+
+                    auto const& channel_state = channels_[channel_index].shared_state_ptr();
+                    auto const lock = std::scoped_lock{channel_state->mutex()};
+                    channel_state->reader_list().dequeue(waiter_node);
+                }
+
+                wait_state.waiter_nodes.clear();
+            }
+
+            [[nodiscard]] auto get_result(std::size_t const successful_alternative) const noexcept -> result_type
+            {
+                assert(successful_alternative < channels_.size());
+                auto const& channel = channels_[successful_alternative];
+
+                if constexpr (std::is_void_v<T>)
+                {
+                    return result_type{successful_alternative, channel};
+                }
+                else
+                {
+                    return result_type{successful_alternative, slot_.read(), channel};
+                }
+            }
+
+          private:
+            std::span<Channel> channels_;
+            [[no_unique_address]] mutable slot_type slot_;
+        };
+
+        template <any_channel_type Channel>
+        read_any(std::span<Channel>) -> read_any<typename Channel::send_type, Channel>;
+
+        // clang-format off
+        template <std::ranges::contiguous_range Channels>
+        requires any_channel_type<std::remove_reference_t<std::ranges::range_reference_t<Channels>>>
+        read_any(Channels&) -> read_any<
+            typename std::remove_cvref_t<std::ranges::range_reference_t<Channels>>::send_type,
+            std::remove_reference_t<std::ranges::range_reference_t<Channels>>>;
+        // clang-format on
+    }  // namespace ops
+}  // namespace asiochan
@@ -3,6 +3,7 @@
 #include <array>
 #include <concepts>
 #include <cstddef>
+#include <memory>
 #include <optional>
 #include <type_traits>
 #include <utility>
@@ -10,8 +11,10 @@
 #include "asiochan/asio.hpp"
 #include "asiochan/channel_concepts.hpp"
 #include "asiochan/detail/channel_op_result_base.hpp"
+#include "asiochan/detail/channel_shared_state.hpp"
 #include "asiochan/detail/channel_waiter_list.hpp"
 #include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/wakeup_batch.hpp"
 #include "asiochan/select_concepts.hpp"
 #include "asiochan/sendable.hpp"
 
@@ -80,6 +83,7 @@ namespace asiochan
 
             static constexpr auto num_alternatives = 1u + sizeof...(ChannelsTail);
             static constexpr auto always_waitfree = false;
+            static constexpr auto reusable = true;
 
             struct wait_state_type
             {
@@ -100,9 +104,10 @@ namespace asiochan
                      ([&]<typename ChannelState>(const ChannelState& channel_state)
                       {
                           constexpr auto channel_index = indices;
+                          auto wakeups = detail::wakeup_batch<executor_type>{};
                           auto const lock = std::scoped_lock{channel_state->mutex()};
 
-                          if constexpr (ChannelState::element_type::buff_size != 0)
+                          if constexpr (std::pointer_traits<ChannelState>::element_type::buff_size != 0)
                           {
                               if (not channel_state->buffer().empty())
                               {
@@ -110,15 +115,10 @@ namespace asiochan
                                   channel_state->buffer().dequeue(slot_);
                                   ready_alternative = channel_index;
 
-                                  if constexpr (not ChannelState::element_type::write_never_waits)
+                                  if constexpr (not std::pointer_traits<ChannelState>::element_type::write_never_waits)
                                   {
-                                      if (auto const writer = channel_state->writer_list().dequeue_first_available())
-                                      {
-                                          // Buffer was full with writers waiting.
-                                          // Wake the oldest writer and store his value in the buffer.
-                                          channel_state->buffer().enqueue(*writer->slot);
-                                          detail::notify_waiter(*writer);
-                                      }
+                                      // Wake writers that waited for space, oldest first.
+                                      channel_state->refill_from_writers(wakeups);
                                   }
 
                                   return true;
@@ -128,7 +128,7 @@ namespace asiochan
                           {
                               // Get a value directly from a waiting writer.
                               transfer(*writer->slot, slot_);
-                              detail::notify_waiter(*writer);
+                              wakeups.add(*writer);
                               ready_alternative = channel_index;
 
                               return true;
@@ -156,9 +156,18 @@ namespace asiochan
                              {
                                  constexpr auto channel_index = indices;
                                  auto const token = base_token + channel_index;
+
+                                 if (auto const& kept_node = wait_state.waiter_nodes[channel_index];
+                                     kept_node.has_value() and detail::still_linked(select_ctx, *kept_node))
+                                 {
+                                     // Still registered from a previous wait, so no value arrived since.
+                                     return false;
+                                 }
+
+                                 auto wakeups = detail::wakeup_batch<executor_type>{};
                                  auto const lock = std::scoped_lock{channel_state->mutex()};
 
-                                 if constexpr (ChannelState::element_type::buff_size != 0)
+                                 if constexpr (std::pointer_traits<ChannelState>::element_type::buff_size != 0)
                                  {
                                      if (not channel_state->buffer().empty())
                                      {
@@ -171,15 +180,10 @@ namespace asiochan
                                          // Get a value from the buffer.
                                          channel_state->buffer().dequeue(slot_);
 
-                                         if constexpr (not ChannelState::element_type::write_never_waits)
+                                         if constexpr (not std::pointer_traits<ChannelState>::element_type::write_never_waits)
                                          {
-                                             if (auto const writer = channel_state->writer_list().dequeue_first_available())
-                                             {
-                                                 // Buffer was full with writers waiting.
-                                                 // Wake the oldest writer and store his value in the buffer.
-                                                 channel_state->buffer().enqueue(*writer->slot);
-                                                 detail::notify_waiter(*writer);
-                                             }
+                                             // Wake writers that waited for space, oldest first.
+                                             channel_state->refill_from_writers(wakeups);
                                          }
 
                                          ready_alternative = channel_index;
@@ -191,11 +195,16 @@ namespace asiochan
                                  {
                                      // Get a value directly from a waiting writer.
                                      transfer(*writer->slot, slot_);
-                                     detail::notify_waiter(*writer);
+                                     wakeups.add(*writer);
                                      ready_alternative = channel_index;
 
                                      return true;
                                  }
+                                 else if (not channel_state->writer_list().empty())
+                                 {
+                                     // A different waiting operation succeeded concurrently
+                                     return true;
+                                 }
 
                                  // Wait for a value.
                                  auto& waiter_node = wait_state.waiter_nodes[channel_index].emplace();
@@ -204,7 +213,8 @@ namespace asiochan
                                  waiter_node.token = token;
                                  waiter_node.next = nullptr;
 
-                                 channel_state->reader_list().enqueue(waiter_node);
+                                 detail::enqueue_waiter<detail::waiter_list_side::readers>(*channel_state, waiter_node);
+                                 channel_state->notify_writable();
 
                                  return false;
                              }(std::get<indices>(channels_).shared_state_ptr())
@@ -225,9 +235,11 @@ namespace asiochan
                           constexpr auto channel_index = indices;
                           auto& waiter_node = wait_state.waiter_nodes[channel_index];
 
-                          if (channel_index == successful_alternative or not waiter_node.has_value())
+                          if (channel_index == successful_alternative or not waiter_node.has_value()
+                              or not detail::still_linked(*waiter_node->ctx, *waiter_node))
                           {
-                              // No need to clear wait on a successful or unsubmitted sub-operation
+                              // No need to clear wait on a successful, unsubmitted or already
+                              // unlinked sub-operation
                               return;
                           }
 
@@ -272,7 +284,7 @@ namespace asiochan
             }
 
           private:
-            std::tuple<ChannelsHead&, ChannelsTail&...> channels_;
+            std::tuple<detail::op_channel_storage_t<ChannelsHead>, detail::op_channel_storage_t<ChannelsTail>...> channels_;
             [[no_unique_address]] mutable slot_type slot_;
         };
 
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_buff_size.hpp"
+#include "asiochan/pipeline.hpp"
+
+namespace asiochan
+{
+    // Turns values into bytes and back, for sending them to another process.
+    // encode() appends the bytes of a value; decode() gets exactly the bytes of one value.
+    // clang-format off
+    template <typename Codec, typename T>
+    concept message_codec = requires (Codec& codec,
+                                      T const& value,
+                                      std::vector<std::byte>& out,
+                                      std::span<std::byte const> const bytes)
+    {
+        codec.encode(value, out);
+        { codec.decode(bytes) } -> std::convertible_to<T>;
+    };
+    // clang-format on
+
+    // Copies the object representation, for peers built from the same code on the same platform.
+    // A frame of another size than T throws system_error with asio::error::message_size.
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    class trivial_codec
+    {
+      public:
+        static void encode(T const& value, std::vector<std::byte>& out)
+        {
+            auto const bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+            out.insert(out.end(), bytes.begin(), bytes.end());
+        }
+
+        [[nodiscard]] static auto decode(std::span<std::byte const> const bytes) -> T
+        {
+            if (bytes.size() != sizeof(T))
+            {
+                throw system::system_error{asio::error::make_error_code(asio::error::message_size)};
+            }
+
+            auto copy = std::array<std::byte, sizeof(T)>{};
+            std::memcpy(copy.data(), bytes.data(), copy.size());
+            return std::bit_cast<T>(copy);
+        }
+    };
+
+    namespace detail
+    {
+        // Frames are a 32 bit little endian length followed by the encoded value. Credits
+        // flow back as 32 bit counts.
+        inline constexpr auto remote_header_size = std::size_t{4};
+        inline constexpr auto remote_end_of_stream = std::uint32_t{0xffffffff};
+
+        inline auto encode_u32(std::uint32_t const value) noexcept -> std::array<std::byte, remote_header_size>
+        {
+            return {
+                std::byte(value),
+                std::byte(value >> 8),
+                std::byte(value >> 16),
+                std::byte(value >> 24),
+            };
+        }
+
+        inline auto decode_u32(std::byte const* const bytes) noexcept -> std::uint32_t
+        {
+            return std::to_integer<std::uint32_t>(bytes[0])
+                   | std::to_integer<std::uint32_t>(bytes[1]) << 8
+                   | std::to_integer<std::uint32_t>(bytes[2]) << 16
+                   | std::to_integer<std::uint32_t>(bytes[3]) << 24;
+        }
+
+        // The frames of one batch, written with a single gathering write.
+        class remote_batch
+        {
+          public:
+            template <typename Encode>
+            void add(Encode encode)
+            {
+                auto const offset = payload_.size();
+                encode(payload_);
+                frames_.push_back({offset, payload_.size() - offset});
+            }
+
+            void add_end_of_stream()
+            {
+                frames_.push_back({payload_.size(), remote_end_of_stream});
+            }
+
+            [[nodiscard]] auto buffers() -> std::vector<asio::const_buffer> const&
+            {
+                headers_.clear();
+                for (auto const& frame : frames_)
+                {
+                    headers_.push_back(encode_u32(static_cast<std::uint32_t>(frame.length)));
+                }
+
+                buffers_.clear();
+                for (auto index = std::size_t{0}; index < frames_.size(); ++index)
+                {
+                    auto const& frame = frames_[index];
+                    buffers_.push_back(asio::buffer(headers_[index]));
+                    if (frame.length != remote_end_of_stream)
+                    {
+                        buffers_.push_back(asio::buffer(payload_.data() + frame.offset, frame.length));
+                    }
+                }
+
+                return buffers_;
+            }
+
+            void clear() noexcept
+            {
+                frames_.clear();
+                payload_.clear();
+            }
+
+          private:
+            struct frame
+            {
+                std::size_t offset;
+                std::size_t length;
+            };
+
+            std::vector<frame> frames_;
+            std::vector<std::byte> payload_;
+            std::vector<std::array<std::byte, remote_header_size>> headers_;
+            std::vector<asio::const_buffer> buffers_;
+        };
+
+        // Credit grants of the receiver; 0 means that the connection was closed.
+        template <asio::execution::executor Executor>
+        using remote_credits = basic_channel<std::size_t, unbounded_channel_buff, channel_stream_mode::block_until_available, Executor>;
+
+        // The socket of a sender is only used on its strand, as the credits are read while
+        // values are written.
+        template <asio::execution::executor Executor>
+        using remote_strand = asio::strand<Executor>;
+
+        template <asio::execution::executor Executor, typename Socket>
+        auto read_remote_credits(std::shared_ptr<Socket> socket, remote_credits<Executor> credits)
+            -> asio::awaitable<void, remote_strand<Executor>>
+        {
+            auto bytes = std::array<std::byte, remote_header_size>{};
+            auto error = system::error_code{};
+            while (true)
+            {
+                co_await asio::async_read(
+                    *socket,
+                    asio::buffer(bytes),
+                    asio::redirect_error(asio::use_awaitable_t<remote_strand<Executor>>{}, error));
+                if (error)
+                {
+                    break;
+                }
+                credits.write(decode_u32(bytes.data()));
+            }
+
+            credits.write(0);
+        }
+
+        // Writes a batch of a sender, and shuts down the sending side after the end of the stream.
+        template <asio::execution::executor Executor, typename Socket>
+        auto write_remote_batch(std::shared_ptr<Socket> socket, remote_batch& batch, bool const ended)
+            -> asio::awaitable<void, remote_strand<Executor>>
+        {
+            co_await asio::async_write(*socket, batch.buffers(), asio::use_awaitable_t<remote_strand<Executor>>{});
+            if (ended)
+            {
+                socket->shutdown(Socket::shutdown_send);
+            }
+        }
+
+        // Ends the output of a receiver whose connection failed, and throws unless the
+        // peer just closed it.
+        template <any_writable_stream_type Out>
+        auto end_remote_stream(Out const& out, system::error_code const error)
+            -> asio::awaitable<void, typename Out::executor_type>
+        {
+            co_await write_stage(out, std::nullopt);
+            if (error != asio::error::eof
+                and error != asio::error::connection_reset
+                and error != asio::error::broken_pipe)
+            {
+                throw system::system_error{error};
+            }
+        }
+
+        template <typename Out>
+        inline constexpr auto default_remote_window
+            = is_unbounded(Out::buff_size) or is_dynamic(Out::buff_size) or is_budgeted(Out::buff_size)
+                  ? stage_batch_size
+                  : std::max<std::size_t>(Out::buff_size, 1);
+    }  // namespace detail
+
+    // Connects streams in different processes over a stream socket, e.g. TCP or a Unix
+    // domain socket. send() forwards the values of a local stream to the receive() at
+    // the other end of the connection, which writes them to its output stream.
+    //
+    // The receiver grants the sender credit for window values at a time, the capacity of
+    // its output by default, so that values wait in the output rather than in socket
+    // buffers. The sender takes only as many values from its input as it has credit for,
+    // and writes all values available at once as a single gathered write.
+    //
+    // The sender reads credits while it writes values, so it uses its socket only on a
+    // strand of its executor, and may run on a multithreaded io_context.
+    //
+    // Both complete after the end of the stream was passed on, or the peer closed the
+    // connection; they throw on other socket errors. The receiver ends its output when
+    // the connection was closed early as well, and when it throws because a frame is
+    // longer than max_frame_size or cannot be decoded.
+    namespace remote
+    {
+        inline constexpr auto default_max_frame_size = std::size_t{1} << 20;
+
+        // clang-format off
+        template <typename Socket,
+                  any_readable_stream_type In,
+                  message_codec<stream_value_t<In>> Codec = trivial_codec<stream_value_t<In>>>
+        auto send(Socket socket, In in, Codec codec = {})
+            -> asio::awaitable<void, typename In::executor_type>
+        // clang-format on
+        {
+            using executor_type = typename In::executor_type;
+
+            auto const shared_socket = std::make_shared<Socket>(std::move(socket));
+            auto const strand = asio::make_strand(co_await asio::this_coro::executor);
+            auto const credits = detail::remote_credits<executor_type>{};
+            asio::co_spawn(
+                strand,
+                detail::read_remote_credits<executor_type>(shared_socket, credits),
+                asio::detached);
+
+            auto available = std::size_t{0};
+            auto batch = detail::remote_batch{};
+            auto ended = false;
+
+            while (not ended)
+            {
+                while (available == 0)
+                {
+                    auto const granted = co_await credits.read();
+                    if (granted == 0)
+                    {
+                        co_return;
+                    }
+                    available += granted;
+                }
+                while (auto const granted = credits.try_read())
+                {
+                    if (*granted == 0)
+                    {
+                        co_return;
+                    }
+                    available += *granted;
+                }
+
+                batch.clear();
+                auto value = co_await in.read();
+                while (true)
+                {
+                    if (not value.has_value())
+                    {
+                        batch.add_end_of_stream();
+                        ended = true;
+                        break;
+                    }
+
+                    batch.add([&](std::vector<std::byte>& out) { codec.encode(*value, out); });
+                    if (--available == 0)
+                    {
+                        break;
+                    }
+
+                    auto next = in.try_read();
+                    if (not next.has_value())
+                    {
+                        break;
+                    }
+                    value = std::move(*next);
+                }
+
+                co_await asio::co_spawn(
+                    strand,
+                    detail::write_remote_batch<executor_type>(shared_socket, batch, ended),
+                    asio::use_awaitable_t<executor_type>{});
+            }
+        }
+
+        // clang-format off
+        template <typename Socket,
+                  any_writable_stream_type Out,
+                  message_codec<stream_value_t<Out>> Codec = trivial_codec<stream_value_t<Out>>>
+        auto receive(
+            Socket socket,
+            Out out,
+            Codec codec = {},
+            std::size_t const window = detail::default_remote_window<Out>,
+            std::size_t const max_frame_size = default_max_frame_size)
+            -> asio::awaitable<void, typename Out::executor_type>
+        // clang-format on
+        {
+            using executor_type = typename Out::executor_type;
+
+            auto error = system::error_code{};
+            auto grant = detail::encode_u32(static_cast<std::uint32_t>(window));
+            co_await asio::async_write(
+                socket,
+                asio::buffer(grant),
+                asio::redirect_error(asio::use_awaitable_t<executor_type>{}, error));
+            if (error)
+            {
+                co_await detail::end_remote_stream(out, error);
+                co_return;
+            }
+
+            // Credits are returned in batches of half the window.
+            auto const grant_threshold = std::max<std::size_t>(window / 2, 1);
+            auto returned = std::size_t{0};
+
+            auto buffer = std::vector<std::byte>(4096);
+            auto begin = std::size_t{0};
+            auto end = std::size_t{0};
+
+            while (true)
+            {
+                // Pass on all complete frames in the buffer.
+                while (end - begin >= detail::remote_header_size)
+                {
+                    auto const length = detail::decode_u32(buffer.data() + begin);
+                    if (length == detail::remote_end_of_stream)
+                    {
+                        co_await detail::write_stage(out, std::nullopt);
+                        co_return;
+                    }
+                    if (length > max_frame_size)
+                    {
+                        // Before growing the buffer to a length sent by the peer.
+                        co_await detail::end_remote_stream(out, asio::error::message_size);
+                        co_return;
+                    }
+                    if (end - begin < detail::remote_header_size + length)
+                    {
+                        break;
+                    }
+
+                    auto const bytes = std::span{buffer}.subspan(begin + detail::remote_header_size, length);
+                    auto value = typename Out::send_type{};
+                    auto failure = std::exception_ptr{};
+                    try
+                    {
+                        value = typename Out::send_type{codec.decode(bytes)};
+                    }
+                    catch (...)
+                    {
+                        failure = std::current_exception();
+                    }
+                    if (failure)
+                    {
+                        co_await detail::write_stage(out, std::nullopt);
+                        std::rethrow_exception(failure);
+                    }
+                    co_await detail::write_stage(out, std::move(value));
+                    begin += detail::remote_header_size + length;
+
+                    if (++returned == grant_threshold)
+                    {
+                        grant = detail::encode_u32(static_cast<std::uint32_t>(returned));
+                        co_await asio::async_write(
+                            socket,
+                            asio::buffer(grant),
+                            asio::redirect_error(asio::use_awaitable_t<executor_type>{}, error));
+                        if (error)
+                        {
+                            co_await detail::end_remote_stream(out, error);
+                            co_return;
+                        }
+                        returned = 0;
+                    }
+                }
+
+                // Move the incomplete frame to the front, and make room for all of it.
+                std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+                end -= begin;
+                begin = 0;
+                if (end >= detail::remote_header_size)
+                {
+                    auto const needed = detail::remote_header_size + detail::decode_u32(buffer.data());
+                    buffer.resize(std::max(buffer.size(), needed));
+                }
+
+                auto const size = co_await socket.async_read_some(
+                    asio::buffer(buffer.data() + end, buffer.size() - end),
+                    asio::redirect_error(asio::use_awaitable_t<executor_type>{}, error));
+                if (error)
+                {
+                    co_await detail::end_remote_stream(out, error);
+                    co_return;
+                }
+                end += size;
+            }
+        }
+    }  // namespace remote
+}  // namespace asiochan
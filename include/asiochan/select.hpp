@@ -1,10 +1,12 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <exception>
 #include <mutex>
 #include <optional>
+#include <ranges>
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
@@ -16,7 +18,9 @@
 #include "asiochan/detail/channel_shared_state.hpp"
 #include "asiochan/detail/channel_waiter_list.hpp"
 #include "asiochan/detail/select_impl.hpp"
+#include "asiochan/detail/select_operation.hpp"
 #include "asiochan/detail/send_slot.hpp"
+#include "asiochan/read_any_op.hpp"
 #include "asiochan/select_concepts.hpp"
 #include "asiochan/select_result.hpp"
 
@@ -33,8 +37,14 @@ namespace asiochan
         auto result = std::optional<select_result<Ops...>>{};
         auto submit_mutex = std::mutex{};
         auto wait_ctx = detail::select_wait_context<Executor>{detail::select_async_tag};
+        wait_ctx.track_waiters = (Ops::num_alternatives + ...) > 1;
         auto ops_wait_states = std::tuple<typename Ops::wait_state_type...>{};
 
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+        auto const cancellation_slot = (co_await asio::this_coro::cancellation_state).slot();
+        detail::cancel_wait_on(cancellation_slot, wait_ctx);
+#endif
+
         auto const success_token = co_await suspend_with_promise<detail::select_waiter_token, Executor>(
             [](async_promise<detail::select_waiter_token, Executor>&& promise,
                auto* const submit_mutex,
@@ -105,90 +115,164 @@ namespace asiochan
               ...);
          }(std::index_sequence_for<Ops...>{}));
 
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+        detail::finish_cancellable_wait(cancellation_slot, success_token);
+#endif
+
         assert(result.has_value());
 
         co_return std::move(*result);
     }
 
-    // clang-format off
-    template <select_op... Ops>
-    requires waitable_selection<Ops...>
-    auto select_sync(interrupter_t & interrupter, Ops... ops_args)
-        -> std::optional<select_result<Ops...>>
-    // clang-format on
+    // Like select, but completes a completion token with the select_result, e.g. a
+    // callback, asio::use_future or asio::use_awaitable. The operations come first and
+    // the token last: async_select(ops::read(a), ops::read(b), token). The channels of
+    // the operations must outlive the operation, unless they are channel_refs of
+    // channels kept alive otherwise. Handlers without an associated executor run on
+    // asio's system executor.
+    template <typename... Args>
+    requires (sizeof...(Args) >= 2u)
+    auto async_select(Args&&... args)
     {
-        using wait_context_type = detail::select_wait_context<typename detail::head_t<Ops...>::executor_type>;
-        auto result = std::optional<select_result<Ops...>>{};
-        auto wait_ctx = detail::select_wait_context<typename detail::head_t<Ops...>::executor_type>(detail::select_sync_tag, interrupter);
-        auto ops_wait_states = std::tuple<typename Ops::wait_state_type...>{};
-        
-        auto ready_token = std::optional<std::size_t>{};
+        auto&& args_tuple = std::forward_as_tuple(std::forward<Args>(args)...);
+        auto& token = std::get<sizeof...(Args) - 1u>(args_tuple);
 
-        ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+        return [&]<std::size_t... indices>(std::index_sequence<indices...>)
         {
-            ([&]<std::size_t channel_index>(auto& op, detail::constant<channel_index>)
-            {
-                constexpr auto op_base_token = detail::select_ops_base_tokens<Ops...>[channel_index];
+            using result_type = select_result<std::decay_t<std::tuple_element_t<indices, std::tuple<Args...>>>...>;
+
+            return detail::async_select_with<void(result_type)>(
+                token,
+                [](result_type&& result) { return std::move(result); },
+                std::tuple<>{},
+                std::get<indices>(std::move(args_tuple))...);
+        }(std::make_index_sequence<sizeof...(Args) - 1u>{});
+    }
 
-                if (auto const ready_alternative = op.submit_with_wait(
-                        wait_ctx,
-                        op_base_token,
-                        std::get<channel_index>(ops_wait_states)))
+    namespace detail
+    {
+        // Runs a blocking select. wait_fn waits on the sync promise and returns false when
+        // the wait was given up, in which case nullopt is returned.
+        // clang-format off
+        template <typename WaitFn, select_op... Ops>
+        requires waitable_selection<Ops...>
+        auto select_sync_impl(interrupter_t& interrupter, WaitFn wait_fn, Ops... ops_args)
+            -> std::optional<select_result<Ops...>>
+        // clang-format on
+        {
+            using wait_context_type = detail::select_wait_context<typename detail::head_t<Ops...>::executor_type>;
+            auto result = std::optional<select_result<Ops...>>{};
+            auto wait_ctx = detail::select_wait_context<typename detail::head_t<Ops...>::executor_type>(detail::select_sync_tag, interrupter);
+            wait_ctx.track_waiters = (Ops::num_alternatives + ...) > 1;
+            auto ops_wait_states = std::tuple<typename Ops::wait_state_type...>{};
+        
+            auto ready_token = std::optional<std::size_t>{};
+
+            ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+            {
+                ([&]<std::size_t channel_index>(auto& op, detail::constant<channel_index>)
                 {
-                    ready_token = op_base_token + *ready_alternative;
+                    constexpr auto op_base_token = detail::select_ops_base_tokens<Ops...>[channel_index];
 
-                    return true;
-                }
+                    if (auto const ready_alternative = op.submit_with_wait(
+                            wait_ctx,
+                            op_base_token,
+                            std::get<channel_index>(ops_wait_states)))
+                    {
+                        ready_token = op_base_token + *ready_alternative;
 
-                return false;
-            }(ops_args, detail::constant<indices>{})
-            or ...);
-        }(std::index_sequence_for<Ops...>{}));
+                        return true;
+                    }
 
+                    return false;
+                }(ops_args, detail::constant<indices>{})
+                or ...);
+            }(std::index_sequence_for<Ops...>{}));
 
-        if (!ready_token)
-        {
-            if (!wait_ctx.get_sync_promise().wait())
+
+            if (!ready_token)
             {
-                ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+                if (!wait_fn(wait_ctx.get_sync_promise()))
                 {
-                    ([&]<select_op Op, std::size_t channel_index>(Op& op, detail::constant<channel_index>)
+                    ([&]<std::size_t... indices>(std::index_sequence<indices...>)
                     {
-                        op.clear_wait(std::nullopt, std::get<channel_index>(ops_wait_states));
-                    }(ops_args, detail::constant<indices>{}),
-                    ...);
-                }(std::index_sequence_for<Ops...>{}));
-                return std::nullopt;
+                        ([&]<select_op Op, std::size_t channel_index>(Op& op, detail::constant<channel_index>)
+                        {
+                            op.clear_wait(std::nullopt, std::get<channel_index>(ops_wait_states));
+                        }(ops_args, detail::constant<indices>{}),
+                        ...);
+                    }(std::index_sequence_for<Ops...>{}));
+                    return std::nullopt;
+                }
+                ready_token = wait_ctx.get_sync_promise().value;
             }
-            ready_token = wait_ctx.get_sync_promise().value;
-        }
-        auto success_token = *ready_token;
+            auto success_token = *ready_token;
 
-        ([&]<std::size_t... indices>(std::index_sequence<indices...>)
-         {
-             ([&]<select_op Op, std::size_t channel_index>(Op& op, detail::constant<channel_index>)
-              {
-                  constexpr auto op_base_token = detail::select_ops_base_tokens<Ops...>[channel_index];
+            ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+             {
+                 ([&]<select_op Op, std::size_t channel_index>(Op& op, detail::constant<channel_index>)
+                  {
+                      constexpr auto op_base_token = detail::select_ops_base_tokens<Ops...>[channel_index];
 
-                  auto successful_alternative = std::optional<std::size_t>{};
+                      auto successful_alternative = std::optional<std::size_t>{};
 
-                  if (success_token >= op_base_token
-                      and success_token < op_base_token + Op::num_alternatives)
-                  {
-                      successful_alternative = success_token - op_base_token;
-                      result.emplace(op.get_result(*successful_alternative), success_token);
-                  }
+                      if (success_token >= op_base_token
+                          and success_token < op_base_token + Op::num_alternatives)
+                      {
+                          successful_alternative = success_token - op_base_token;
+                          result.emplace(op.get_result(*successful_alternative), success_token);
+                      }
 
-                  op.clear_wait(
-                      successful_alternative,
-                      std::get<channel_index>(ops_wait_states));
-              }(ops_args, detail::constant<indices>{}),
-              ...);
-         }(std::index_sequence_for<Ops...>{}));
+                      op.clear_wait(
+                          successful_alternative,
+                          std::get<channel_index>(ops_wait_states));
+                  }(ops_args, detail::constant<indices>{}),
+                  ...);
+             }(std::index_sequence_for<Ops...>{}));
 
-        assert(result.has_value());
+            assert(result.has_value());
+
+            return result;
+        }
+    }  // namespace detail
 
-        return std::move(result);
+    // clang-format off
+    template <select_op... Ops>
+    requires waitable_selection<Ops...>
+    auto select_sync(interrupter_t & interrupter, Ops... ops_args)
+        -> std::optional<select_result<Ops...>>
+    // clang-format on
+    {
+        return detail::select_sync_impl(
+            interrupter,
+            [](auto& promise) { return promise.wait(); },
+            std::move(ops_args)...);
+    }
+
+    // Blocks until one of the operations completes or the deadline passes.
+    // Returns nullopt on timeout, with no operation performed.
+    // clang-format off
+    template <typename Clock, typename Duration, select_op... Ops>
+    requires waitable_selection<Ops...>
+    auto select_sync_until(std::chrono::time_point<Clock, Duration> const deadline, Ops... ops_args)
+        -> std::optional<select_result<Ops...>>
+    // clang-format on
+    {
+        auto interrupter = interrupter_t{};
+        return detail::select_sync_impl(
+            interrupter,
+            [&](auto& promise) { return promise.wait_until(deadline); },
+            std::move(ops_args)...);
+    }
+
+    // clang-format off
+    template <typename Rep, typename Period, select_op... Ops>
+    requires waitable_selection<Ops...>
+    auto select_sync_for(std::chrono::duration<Rep, Period> const timeout, Ops... ops_args)
+        -> std::optional<select_result<Ops...>>
+    // clang-format on
+    {
+        return select_sync_until(std::chrono::steady_clock::now() + timeout, std::move(ops_args)...);
     }
 
     // clang-format off
@@ -223,4 +307,18 @@ namespace asiochan
 
         return std::move(*result);
     }
+
+    // clang-format off
+    template <std::ranges::contiguous_range Channels,
+              typename Channel = std::remove_reference_t<std::ranges::range_reference_t<Channels>>,
+              asio::execution::executor Executor = typename Channel::executor_type>
+    requires any_readable_channel_type<std::remove_const_t<Channel>>
+    [[nodiscard]] auto select_range(Channels&& channels)
+        -> asio::awaitable<read_any_result<typename Channel::send_type>, Executor>
+    // clang-format on
+    {
+        auto result = co_await select(ops::read_any(std::span<Channel>{channels}));
+
+        co_return std::move(result).template get<read_any_result<typename Channel::send_type>>();
+    }
 }  // namespace asiochan
@@ -60,6 +60,12 @@ namespace asiochan
               };
           };
 
+    // Operations whose waiter registrations can be kept across waits, see selector.
+    template <typename T>
+    concept reusable_select_op
+        = waitable_select_op<T>
+          and requires { requires T::reusable; };
+
     template <typename... Ops>
     concept waitfree_selection
         = (sizeof...(Ops) >= 1u)
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/async_promise.hpp"
+#include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/detail/select_impl.hpp"
+#include "asiochan/select_concepts.hpp"
+#include "asiochan/select_result.hpp"
+
+namespace asiochan
+{
+    // A select over a fixed set of read operations that is awaited repeatedly.
+    //
+    // Unlike select(), waiter registrations are kept between waits: after a wakeup only
+    // the alternative that completed is registered again, instead of locking and
+    // registering on every channel per wait. The registrations are removed when the
+    // selector is destroyed.
+    //
+    // The operations refer to their channels, which must outlive the selector. Only one
+    // wait() may be pending at a time, and the selector must outlive it.
+    // clang-format off
+    template <select_op... Ops>
+    requires waitable_selection<Ops...> and (reusable_select_op<Ops> and ...)
+    class selector
+    // clang-format on
+    {
+      public:
+        using executor_type = typename detail::head_t<Ops...>::executor_type;
+        using result_type = select_result<Ops...>;
+
+        explicit selector(Ops... ops_args)
+          : ops_{std::move(ops_args)...}
+        {
+            wait_ctx_.track_waiters = false;
+        }
+
+        selector(selector const&) = delete;
+        auto operator=(selector const&) -> selector& = delete;
+
+        ~selector() noexcept
+        {
+            std::apply(
+                [&](auto&... ops_args)
+                {
+                    ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+                     {
+                         (ops_args.clear_wait(std::nullopt, std::get<indices>(wait_states_)), ...);
+                     }(std::index_sequence_for<Ops...>{}));
+                },
+                ops_);
+        }
+
+        [[nodiscard]] auto wait() -> asio::awaitable<result_type, executor_type>
+        {
+            auto submit_mutex = std::mutex{};
+
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+            auto const cancellation_slot = (co_await asio::this_coro::cancellation_state).slot();
+            detail::cancel_wait_on(cancellation_slot, wait_ctx_);
+#endif
+
+            auto const success_token = co_await suspend_with_promise<detail::select_waiter_token, executor_type>(
+                [this, &submit_mutex](async_promise<detail::select_waiter_token, executor_type>&& promise)
+                {
+                    wait_ctx_.rearm(std::move(promise));
+
+                    auto ready_token = std::optional<std::size_t>{};
+
+                    {
+                        auto const submit_lock = std::scoped_lock{submit_mutex};
+
+                        ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+                         {
+                             ([&]<std::size_t op_index>(detail::constant<op_index>)
+                              {
+                                  constexpr auto op_base_token = detail::select_ops_base_tokens<Ops...>[op_index];
+
+                                  if (auto const ready_alternative = std::get<op_index>(ops_).submit_with_wait(
+                                          wait_ctx_,
+                                          op_base_token,
+                                          std::get<op_index>(wait_states_)))
+                                  {
+                                      ready_token = op_base_token + *ready_alternative;
+
+                                      return true;
+                                  }
+
+                                  return false;
+                              }(detail::constant<indices>{})
+                              or ...);
+                         }(std::index_sequence_for<Ops...>{}));
+                    }
+
+                    if (ready_token)
+                    {
+                        wait_ctx_.set_token(*ready_token);
+                    }
+                });
+
+            auto const submit_lock = std::scoped_lock{submit_mutex};
+
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+            // The registrations stay in place, and are claimable again by the next wait.
+            detail::finish_cancellable_wait(cancellation_slot, success_token);
+#endif
+
+            auto result = std::optional<result_type>{};
+
+            ([&]<std::size_t... indices>(std::index_sequence<indices...>)
+             {
+                 ([&]<std::size_t op_index>(detail::constant<op_index>)
+                  {
+                      using op_type = std::tuple_element_t<op_index, std::tuple<Ops...>>;
+                      constexpr auto op_base_token = detail::select_ops_base_tokens<Ops...>[op_index];
+
+                      if (success_token >= op_base_token
+                          and success_token < op_base_token + op_type::num_alternatives)
+                      {
+                          // The other registrations stay in place for the next wait.
+                          result.emplace(std::get<op_index>(ops_).get_result(success_token - op_base_token), success_token);
+                      }
+                  }(detail::constant<indices>{}),
+                  ...);
+             }(std::index_sequence_for<Ops...>{}));
+
+            assert(result.has_value());
+
+            co_return std::move(*result);
+        }
+
+      private:
+        std::tuple<Ops...> ops_;
+        std::tuple<typename Ops::wait_state_type...> wait_states_ = {};
+        detail::select_wait_context<executor_type> wait_ctx_{detail::select_async_tag};
+    };
+}  // namespace asiochan
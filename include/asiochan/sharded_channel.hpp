@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_buff_size.hpp"
+#include "asiochan/channel_mutex.hpp"
+#include "asiochan/select.hpp"
+#include "asiochan/sendable.hpp"
+#include "asiochan/write_op.hpp"
+
+namespace asiochan
+{
+    namespace detail
+    {
+        // The shard a thread uses first, so threads mostly stay on separate locks. Threads
+        // are numbered in the order they first get here, which spreads them evenly over
+        // the shards, unlike the hash of their id that may have few distinct low bits.
+        [[nodiscard]] inline auto home_shard(std::size_t const num_shards) noexcept -> std::size_t
+        {
+            static auto next_thread_index = std::atomic_size_t{0};
+            thread_local auto const thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+            return thread_index % num_shards;
+        }
+    }  // namespace detail
+
+    // A bounded channel striped over several shards with a lock each, for many threads
+    // writing and reading at once. Writers and readers use the shard of their thread
+    // first and go to the others when it is full or empty, and only wait when all are.
+    //
+    // Ordering is relaxed: values written to the same shard are read in order, but values
+    // on different shards are not ordered. In particular, values written one after another
+    // by a coroutine that moved between threads may be read in either order. The capacity
+    // is buff_size per shard.
+    // clang-format off
+    template <sendable T,
+              channel_buff_size buff_size,
+              std::size_t num_shards,
+              asio::execution::executor Executor,
+              channel_mutex Mutex = std::mutex>
+    requires (not std::is_void_v<T>
+              and buff_size > 0
+              and not is_unbounded(buff_size)
+              and not is_dynamic(buff_size)
+              and not is_budgeted(buff_size)
+              and num_shards > 0)
+    class basic_sharded_channel
+    // clang-format on
+    {
+      public:
+        using executor_type = Executor;
+        using send_type = T;
+        using shard_type = basic_channel<T, buff_size, channel_stream_mode::block_until_available, Executor, Mutex>;
+
+        basic_sharded_channel()
+          : shards_{std::make_shared<std::array<shard_type, num_shards>>()}
+        {
+        }
+
+        [[nodiscard]] static constexpr auto shard_count() noexcept -> std::size_t
+        {
+            return num_shards;
+        }
+
+        [[nodiscard]] auto try_write(T value) const -> bool
+        {
+            return try_put(*shards_, value);
+        }
+
+        [[nodiscard]] auto write(T value) const -> asio::awaitable<void, Executor>
+        {
+            return write(shards_, std::move(value));
+        }
+
+        [[nodiscard]] auto try_read() const -> std::optional<T>
+        {
+            return try_take(*shards_);
+        }
+
+        [[nodiscard]] auto read() const -> asio::awaitable<T, Executor>
+        {
+            return read(shards_);
+        }
+
+      private:
+        using shards_type = std::array<shard_type, num_shards>;
+
+        // Moves from the value only when it was written.
+        static auto try_put(shards_type& shards, T& value) -> bool
+        {
+            auto const home = detail::home_shard(num_shards);
+            for (auto offset = std::size_t{0}; offset < num_shards; ++offset)
+            {
+                if (shards[(home + offset) % num_shards].try_write_many(std::span{&value, 1}) == 1)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        static auto try_take(shards_type& shards) -> std::optional<T>
+        {
+            auto const home = detail::home_shard(num_shards);
+            for (auto offset = std::size_t{0}; offset < num_shards; ++offset)
+            {
+                if (auto value = shards[(home + offset) % num_shards].try_read())
+                {
+                    return value;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Hold the shards by value, so the handle may be destroyed while the operation is pending.
+        static auto write(std::shared_ptr<shards_type> shards, T value) -> asio::awaitable<void, Executor>
+        {
+            if (try_put(*shards, value))
+            {
+                co_return;
+            }
+
+            // Every shard is full; write to the first one with space.
+            co_await std::apply(
+                [&](auto&... shard)
+                { return select(ops::write(std::move(value), shard...)); },
+                *shards);
+        }
+
+        static auto read(std::shared_ptr<shards_type> shards) -> asio::awaitable<T, Executor>
+        {
+            if (auto value = try_take(*shards))
+            {
+                co_return std::move(*value);
+            }
+
+            // Every shard is empty; take the first value written to any of them.
+            auto result = co_await select_range(*shards);
+            co_return std::move(result).get();
+        }
+
+        std::shared_ptr<shards_type> shards_;
+    };
+
+    template <sendable T, channel_buff_size buff_size, std::size_t num_shards>
+    using sharded_channel = basic_sharded_channel<T, buff_size, num_shards, asio::any_io_executor>;
+}  // namespace asiochan
@@ -0,0 +1,475 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/detail/channel_observer.hpp"
+#include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/shm_ring.hpp"
+#include "asiochan/detail/wakeup_batch.hpp"
+#include "asiochan/sendable.hpp"
+
+namespace asiochan
+{
+    // A bounded channel between processes, in a shared memory mapping. Values are copied
+    // through a lock-free ring, so T must be trivially copyable, and buff_size a power
+    // of two. Reads and writes between running processes make no syscalls; blocked
+    // readers and writers sleep on a futex.
+    //
+    // The asio side of each process goes through two unbuffered in-process channels:
+    // a thread takes values from the ring when a coroutine of this process waits in
+    // read(), or in a select on reader(), and another thread writes the values of
+    // coroutines waiting in write() to the ring. These threads start on first use.
+    //
+    // Copies of a handle share the mapping and the threads of their process; keep one
+    // alive while using reader(). A process that dies while writing or reading a value
+    // can leave its cell claimed forever.
+    // clang-format off
+    template <sendable T, std::size_t buff_size, asio::execution::executor Executor>
+    requires (std::is_trivially_copyable_v<T> and std::has_single_bit(buff_size))
+    class basic_shm_channel
+    // clang-format on
+    {
+      public:
+        using executor_type = Executor;
+        using send_type = T;
+        using local_channel_type = basic_channel<T, 0, channel_stream_mode::block_until_available, Executor>;
+        using reader_type = basic_read_channel<T, 0, channel_stream_mode::block_until_available, Executor>;
+
+        // Creates a new named segment, see shm_open(). Fails if the name exists.
+        [[nodiscard]] static auto create(std::string const& name) -> basic_shm_channel
+        {
+            auto const fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+            if (fd < 0)
+            {
+                throw std::system_error{errno, std::system_category(), "shm_open"};
+            }
+
+            try
+            {
+                return basic_shm_channel{fd, true};
+            }
+            catch (...)
+            {
+                // Nobody else can have opened the name yet, as it was never initialised.
+                ::shm_unlink(name.c_str());
+                throw;
+            }
+        }
+
+        // Opens a segment created by create() in another process. Waits briefly for
+        // create() to size it, if the name was just created.
+        [[nodiscard]] static auto open(std::string const& name) -> basic_shm_channel
+        {
+            auto const fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+            if (fd < 0)
+            {
+                throw std::system_error{errno, std::system_category(), "shm_open"};
+            }
+
+            return basic_shm_channel{fd, false};
+        }
+
+        // Removes the name of a segment. Mapped handles keep working.
+        static void unlink(std::string const& name)
+        {
+            if (::shm_unlink(name.c_str()) != 0)
+            {
+                throw std::system_error{errno, std::system_category(), "shm_unlink"};
+            }
+        }
+
+        // Creates an unnamed segment, see memfd_create(). Its fd() can be inherited by
+        // child processes or sent over a Unix socket, and passed to open_fd() there.
+        [[nodiscard]] static auto create_anonymous() -> basic_shm_channel
+        {
+            auto const fd = ::memfd_create("asiochan", MFD_CLOEXEC);
+            if (fd < 0)
+            {
+                throw std::system_error{errno, std::system_category(), "memfd_create"};
+            }
+
+            return basic_shm_channel{fd, true};
+        }
+
+        // Opens the segment of the fd of another handle. The fd is duplicated.
+        [[nodiscard]] static auto open_fd(int const fd) -> basic_shm_channel
+        {
+            auto const own_fd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+            if (own_fd < 0)
+            {
+                throw std::system_error{errno, std::system_category(), "fcntl"};
+            }
+
+            return basic_shm_channel{own_fd, false};
+        }
+
+        [[nodiscard]] auto fd() const noexcept -> int
+        {
+            return state_->fd;
+        }
+
+        [[nodiscard]] auto try_write(T const& value) const noexcept -> bool
+        {
+            return state_->ring->try_write(value);
+        }
+
+        [[nodiscard]] auto try_read() const noexcept -> std::optional<T>
+        {
+            return state_->ring->try_read();
+        }
+
+        // Blocks the calling thread.
+        void write_sync(T const& value) const noexcept
+        {
+            static_cast<void>(state_->ring->write_sync(value, never_stop));
+        }
+
+        // Blocks the calling thread.
+        [[nodiscard]] auto read_sync() const noexcept -> T
+        {
+            return *state_->ring->read_sync(never_stop);
+        }
+
+        [[nodiscard]] auto write(T value) const -> asio::awaitable<void, Executor>
+        {
+            return write(state_, value);
+        }
+
+        [[nodiscard]] auto read() const -> asio::awaitable<T, Executor>
+        {
+            return read(state_);
+        }
+
+        // The in-process side of the reads, for use in a select, e.g. ops::read(shm.reader()).
+        // The handle observes it, so it cannot be added to a channel_set or channel_eventfd.
+        [[nodiscard]] auto reader() const -> reader_type
+        {
+            state_->start_reading();
+            return reader_type{state_->inbox};
+        }
+
+      private:
+        using ring_type = detail::shm_ring<T, buff_size>;
+
+        static constexpr auto mapping_size = sizeof(ring_type);
+
+        inline static std::atomic_bool const never_stop = false;
+
+        // How long open() waits for create() to size a new segment.
+        static constexpr auto size_attempts = 1000;
+        static constexpr auto size_retry_interval = std::chrono::milliseconds{1};
+
+        // Counts the coroutines of this process that started waiting on one side, so
+        // that the thread serving that side sleeps while there are none.
+        class demand_observer final : public detail::channel_observer
+        {
+          public:
+            void on_readable() noexcept override
+            {
+                bump();
+            }
+
+            void on_writable() noexcept override
+            {
+                bump();
+            }
+
+            void bump() noexcept
+            {
+                count.fetch_add(1, std::memory_order_release);
+                count.notify_one();
+            }
+
+            std::atomic<std::uint32_t> count = 0;
+        };
+
+        struct state
+        {
+            state(int const fd, bool const initialise)
+              : fd{fd}
+            {
+                if (initialise and ::ftruncate(fd, mapping_size) != 0)
+                {
+                    fail("ftruncate");
+                }
+
+                struct stat status{};
+                for (auto attempt = 0;; ++attempt)
+                {
+                    if (::fstat(fd, &status) != 0)
+                    {
+                        fail("fstat");
+                    }
+                    // create() opens the name before it sets the size.
+                    if (status.st_size != 0 or initialise)
+                    {
+                        break;
+                    }
+                    if (attempt == size_attempts)
+                    {
+                        fail("shm_channel: segment was not initialised", ETIMEDOUT);
+                    }
+                    std::this_thread::sleep_for(size_retry_interval);
+                }
+                if (static_cast<std::size_t>(status.st_size) != mapping_size)
+                {
+                    fail("shm_channel: segment of a different type", EINVAL);
+                }
+
+                mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    fail("mmap");
+                }
+
+                if (initialise)
+                {
+                    ring = ::new (mapping) ring_type{};
+                }
+                else
+                {
+                    ring = std::launder(static_cast<ring_type*>(mapping));
+                    if (not ring->wait_initialised())
+                    {
+                        ::munmap(mapping, mapping_size);
+                        fail("shm_channel: segment of a different type", EINVAL);
+                    }
+                }
+
+                auto& inbox_state = *inbox.shared_state_ptr();
+                auto const inbox_lock = std::scoped_lock{inbox_state.mutex()};
+                inbox_state.set_observer(&read_demand);
+
+                auto& outbox_state = *outbox.shared_state_ptr();
+                auto const outbox_lock = std::scoped_lock{outbox_state.mutex()};
+                outbox_state.set_observer(&write_demand);
+            }
+
+            state(state const&) = delete;
+            auto operator=(state const&) -> state& = delete;
+
+            ~state() noexcept
+            {
+                stop.store(true, std::memory_order_release);
+                read_demand.bump();
+                write_demand.bump();
+                ring->interrupt();
+                if (read_pump.joinable())
+                {
+                    read_pump.join();
+                }
+                if (write_pump.joinable())
+                {
+                    write_pump.join();
+                }
+
+                for (auto* local : {inbox.shared_state_ptr().get(), outbox.shared_state_ptr().get()})
+                {
+                    auto const lock = std::scoped_lock{local->mutex()};
+                    local->set_observer(nullptr);
+                }
+
+                ::munmap(mapping, mapping_size);
+                ::close(fd);
+            }
+
+            [[noreturn]] void fail(char const* const what, int const error = errno)
+            {
+                ::close(fd);
+                throw std::system_error{error, std::system_category(), what};
+            }
+
+            void start_reading()
+            {
+                std::call_once(read_pump_started, [this] { read_pump = std::thread{[this] { pump_reads(); }}; });
+            }
+
+            void start_writing()
+            {
+                std::call_once(write_pump_started, [this] { write_pump = std::thread{[this] { pump_writes(); }}; });
+            }
+
+            // Moves a value from the ring whenever a coroutine waits on the inbox.
+            void pump_reads() noexcept
+            {
+                while (not stop.load(std::memory_order_acquire))
+                {
+                    auto const demand = read_demand.count.load(std::memory_order_acquire);
+                    if (not reader_waiting())
+                    {
+                        read_demand.count.wait(demand, std::memory_order_acquire);
+                        continue;
+                    }
+
+                    if (not ring->wait_readable(stop))
+                    {
+                        break;
+                    }
+
+                    // Fails if the reader was claimed by another operation, or another
+                    // process took the value; both are checked again.
+                    static_cast<void>(hand_over());
+                }
+            }
+
+            // Takes a value from the ring only once a waiting reader of the inbox has been
+            // claimed, so no value is taken from the ring that no coroutine receives.
+            [[nodiscard]] auto hand_over() noexcept -> bool
+            {
+                auto wakeups = detail::wakeup_batch<Executor>{};
+                auto& inbox_state = *inbox.shared_state_ptr();
+                auto const lock = std::scoped_lock{inbox_state.mutex()};
+
+                auto value = std::optional<T>{};
+                auto const reader = inbox_state.reader_list().dequeue_first_available_if(
+                    [&](auto&) noexcept { return (value = ring->try_read()).has_value(); });
+                if (not reader)
+                {
+                    return false;
+                }
+
+                auto slot = detail::send_slot<T>{};
+                slot.write(std::move(*value));
+                transfer(slot, *reader->slot);
+                wakeups.add(*reader);
+
+                return true;
+            }
+
+            // Writes the value of every coroutine that waits on the outbox to the ring.
+            void pump_writes() noexcept
+            {
+                while (not stop.load(std::memory_order_acquire))
+                {
+                    auto const demand = write_demand.count.load(std::memory_order_acquire);
+                    if (not writer_waiting())
+                    {
+                        write_demand.count.wait(demand, std::memory_order_acquire);
+                        continue;
+                    }
+
+                    if (not ring->wait_writable(stop))
+                    {
+                        break;
+                    }
+
+                    // Fails if the writer was claimed by another operation, or another
+                    // process took the cell; both are checked again.
+                    if (take_over())
+                    {
+                        pending_writes.fetch_sub(1, std::memory_order_release);
+                    }
+                }
+            }
+
+            // Completes a waiting writer of the outbox only once its value is in the ring,
+            // so no value has left the coroutine that is not stored in the segment yet.
+            [[nodiscard]] auto take_over() noexcept -> bool
+            {
+                auto wakeups = detail::wakeup_batch<Executor>{};
+                auto& outbox_state = *outbox.shared_state_ptr();
+                auto const lock = std::scoped_lock{outbox_state.mutex()};
+
+                auto const writer = outbox_state.writer_list().dequeue_first_available_if(
+                    [&](auto& node) noexcept { return ring->try_write(*node.slot->value()); });
+                if (not writer)
+                {
+                    return false;
+                }
+
+                wakeups.add(*writer);
+
+                return true;
+            }
+
+            [[nodiscard]] auto reader_waiting() -> bool
+            {
+                auto& inbox_state = *inbox.shared_state_ptr();
+                auto const lock = std::scoped_lock{inbox_state.mutex()};
+                return inbox_state.writable();
+            }
+
+            [[nodiscard]] auto writer_waiting() -> bool
+            {
+                auto& outbox_state = *outbox.shared_state_ptr();
+                auto const lock = std::scoped_lock{outbox_state.mutex()};
+                return outbox_state.readable();
+            }
+
+            int fd;
+            void* mapping = nullptr;
+            ring_type* ring = nullptr;
+            std::atomic_bool stop = false;
+
+            local_channel_type inbox;
+            local_channel_type outbox;
+            demand_observer read_demand;
+            demand_observer write_demand;
+            // Values of this process that are written through the write thread.
+            std::atomic_size_t pending_writes = 0;
+
+            std::once_flag read_pump_started;
+            std::once_flag write_pump_started;
+            std::thread read_pump;
+            std::thread write_pump;
+        };
+
+        basic_shm_channel(int const fd, bool const initialise)
+          : state_{std::make_shared<state>(fd, initialise)}
+        {
+        }
+
+        // Holds the state by value, so the handle may be destroyed while the operation is pending.
+        static auto write(std::shared_ptr<state> state, T const value) -> asio::awaitable<void, Executor>
+        {
+            // Stay behind earlier values of this process that still wait for space.
+            if (state->pending_writes.load(std::memory_order_acquire) == 0 and state->ring->try_write(value))
+            {
+                co_return;
+            }
+
+            state->start_writing();
+            state->pending_writes.fetch_add(1, std::memory_order_relaxed);
+            co_await state->outbox.write(value);
+        }
+
+        static auto read(std::shared_ptr<state> state) -> asio::awaitable<T, Executor>
+        {
+            if (auto const value = state->ring->try_read())
+            {
+                co_return *value;
+            }
+
+            state->start_reading();
+            co_return co_await state->inbox.read();
+        }
+
+        std::shared_ptr<state> state_;
+    };
+
+    template <sendable T, std::size_t buff_size>
+    using shm_channel = basic_shm_channel<T, buff_size, asio::any_io_executor>;
+}  // namespace asiochan
+
+#endif
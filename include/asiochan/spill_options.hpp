@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ASIOCHAN_HAS_SPILL
+#endif
+
+namespace asiochan
+{
+    // Lets an unbounded channel of a trivially copyable type keep at most memory_limit
+    // values in memory. Further values go to memory-mapped files in directory, of
+    // segment_size values each, until the readers caught up. The files are removed from
+    // the directory right after they are created.
+    struct spill_options
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path();
+        std::size_t memory_limit = std::size_t{1} << 16;
+        std::size_t segment_size = std::size_t{1} << 16;
+    };
+}  // namespace asiochan
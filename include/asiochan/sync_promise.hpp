@@ -3,6 +3,8 @@
 #include "asiochan/interrupter.hpp"
 #include "asiochan/sendable.hpp"
 
+#include <chrono>
+#include <mutex>
 #include <optional>
 
 namespace asiochan
@@ -18,20 +20,47 @@ namespace asiochan
         template <std::convertible_to<T> U>
         void set_value(U&& value)
         {
+            // The waiter checks the value under the same lock, so it never sees a
+            // claimed promise without its value. Notifying under the lock keeps the
+            // waiter from returning and destroying the interrupter before that.
+            std::lock_guard g(interrupter.mux);
             this->value = T{std::forward<U>(value)};
             interrupter.cv.notify_one();
         }
 
         /**
-         * @return true if value is set, or interrupted
+         * @return true if value is set, false if interrupted
          */
         bool wait()
         {
             std::unique_lock lk(interrupter.mux);
             interrupter.cv.wait(lk, [this]() {
-                return !interrupter.available || interrupter.interrupted;
+                return value.has_value() || interrupter.interrupted;
             });
-            return !interrupter.available;
+            return value.has_value();
+        }
+
+        /**
+         * @return true if value is set, false if interrupted or the deadline passed
+         */
+        template <typename Clock, typename Duration>
+        bool wait_until(std::chrono::time_point<Clock, Duration> const& deadline)
+        {
+            std::unique_lock lk(interrupter.mux);
+            if (!interrupter.cv.wait_until(lk, deadline, [this]() {
+                return value.has_value() || interrupter.interrupted;
+            }))
+            {
+                if (!interrupter.available)
+                {
+                    // Claimed just before the deadline, and the value follows shortly.
+                    interrupter.cv.wait(lk, [this]() { return value.has_value(); });
+                    return true;
+                }
+                // Interrupt, so that no operation claims it any more.
+                interrupter.interrupted = true;
+            }
+            return value.has_value();
         }
     };
 
@@ -44,11 +73,14 @@ namespace asiochan
 
         void set_value()
         {
+            // Under the lock, as the waiter may return and destroy the interrupter
+            // as soon as it is released.
+            std::lock_guard g(interrupter.mux);
             interrupter.cv.notify_one();
         }
 
         /**
-         * @return true if value is set, or interrupted
+         * @return true if value is set, false if interrupted
          */
         bool wait()
         {
@@ -58,5 +90,23 @@ namespace asiochan
             });
             return !interrupter.available;
         }
+
+        /**
+         * @return true if value is set, false if interrupted or the deadline passed
+         */
+        template <typename Clock, typename Duration>
+        bool wait_until(std::chrono::time_point<Clock, Duration> const& deadline)
+        {
+            std::unique_lock lk(interrupter.mux);
+            if (!interrupter.cv.wait_until(lk, deadline, [this]() {
+                return !interrupter.available || interrupter.interrupted;
+            }))
+            {
+                // Claiming and setting the value are one step here, so an unclaimed
+                // promise can be interrupted.
+                interrupter.interrupted = true;
+            }
+            return !interrupter.available;
+        }
     };
 } // namespace asiochan
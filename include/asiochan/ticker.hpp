@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/detail/send_slot.hpp"
+
+namespace asiochan
+{
+    template <asio::execution::executor Executor>
+    using basic_ticker_channel = basic_read_channel<void, 1, channel_stream_mode::forget_oldest, Executor>;
+
+    using ticker_channel = basic_ticker_channel<asio::any_io_executor>;
+
+    namespace detail
+    {
+        // The timer behind all tickers of an execution context. Tickers are kept in a heap
+        // by their next tick, and the single timer waits for the earliest one. Tickers
+        // whose channels were dropped, so that only the service refers to them, are
+        // removed when they are due next.
+        template <asio::execution::executor Executor>
+        class ticker_service : public asio::execution_context::service
+        {
+          public:
+            using key_type = ticker_service;
+            using clock = std::chrono::steady_clock;
+            using channel_type = basic_channel<void, 1, channel_stream_mode::forget_oldest, Executor>;
+
+            inline static asio::execution_context::id id;
+
+            explicit ticker_service(asio::execution_context& context)
+              : asio::execution_context::service{context}
+            {
+            }
+
+            void add(Executor const& executor, channel_type const& channel, clock::duration const period)
+            {
+                assert(period > clock::duration::zero());
+                auto const lock = std::scoped_lock{mutex_};
+                if (not timer_)
+                {
+                    timer_.emplace(executor);
+                }
+
+                auto const next = clock::now() + period;
+                tickers_.push({next, period, channel.shared_state_ptr()});
+                if (tickers_.top().next == next)
+                {
+                    arm_timer();
+                }
+            }
+
+          private:
+            using timer_type = asio::basic_waitable_timer<clock, asio::wait_traits<clock>, Executor>;
+
+            struct ticker
+            {
+                clock::time_point next;
+                clock::duration period;
+                typename channel_type::shared_state_ptr_type channel;
+
+                [[nodiscard]] friend auto operator>(ticker const& lhs, ticker const& rhs) noexcept -> bool
+                {
+                    return lhs.next > rhs.next;
+                }
+            };
+
+            void shutdown() override
+            {
+                auto const lock = std::scoped_lock{mutex_};
+                timer_.reset();
+                tickers_ = {};
+            }
+
+            // Must be called with the mutex held.
+            void arm_timer()
+            {
+                // Cancels a wait for a later tick.
+                timer_->expires_at(tickers_.top().next);
+                timer_->async_wait(
+                    [this](system::error_code const error)
+                    {
+                        if (error != asio::error::operation_aborted)
+                        {
+                            tick();
+                        }
+                    });
+            }
+
+            void tick()
+            {
+                auto const lock = std::scoped_lock{mutex_};
+                auto const now = clock::now();
+                while (not tickers_.empty() and tickers_.top().next <= now)
+                {
+                    auto due = tickers_.top();
+                    tickers_.pop();
+
+                    if (due.channel.use_count() == 1)
+                    {
+                        continue;
+                    }
+
+                    // A tick that was not read yet absorbs this one.
+                    static_cast<void>(due.channel->write_ready(1, [](send_slot<void>&, std::size_t) {}));
+
+                    // Ticks missed while the timer was late are coalesced as well.
+                    due.next += due.period * ((now - due.next) / due.period + 1);
+                    tickers_.push(std::move(due));
+                }
+
+                if (not tickers_.empty())
+                {
+                    arm_timer();
+                }
+            }
+
+            std::mutex mutex_;
+            std::optional<timer_type> timer_;
+            std::priority_queue<ticker, std::vector<ticker>, std::greater<>> tickers_;
+        };
+    }  // namespace detail
+
+    // A channel that becomes readable every period, like a time.Ticker in go. Ticks that
+    // were not read yet are coalesced into one. All tickers of an execution context share
+    // a single timer; a ticker stops once all copies of its channel are dropped.
+    template <asio::execution::executor Executor>
+    [[nodiscard]] auto ticker(Executor const& executor, std::chrono::steady_clock::duration const period)
+        -> basic_ticker_channel<Executor>
+    {
+        using service_type = detail::ticker_service<Executor>;
+
+        auto const channel = typename service_type::channel_type{};
+        auto& context = asio::query(executor, asio::execution::context);
+        asio::use_service<service_type>(context).add(executor, channel, period);
+
+        return channel;
+    }
+}  // namespace asiochan
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "asiochan/asio.hpp"
+#include "asiochan/channel.hpp"
+#include "asiochan/channel_buff_size.hpp"
+#include "asiochan/channel_mutex.hpp"
+#include "asiochan/detail/channel_waiter_list.hpp"
+#include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/wakeup_batch.hpp"
+#include "asiochan/select.hpp"
+#include "asiochan/sendable.hpp"
+
+namespace asiochan
+{
+    // Distributes values over one bounded channel per worker. A worker takes values from
+    // its own channel first. When that is empty, it steals half of the values buffered in
+    // another worker's channel in a single locked transfer, and only waits when all
+    // channels are empty.
+    //
+    // Each worker index must be read by a single coroutine at a time. Copies of a pool
+    // share its channels.
+    // clang-format off
+    template <sendable T,
+              channel_buff_size buff_size,
+              asio::execution::executor Executor,
+              channel_mutex Mutex = std::mutex>
+    requires (not std::is_void_v<T>
+              and buff_size > 0
+              and not is_unbounded(buff_size)
+              and not is_dynamic(buff_size)
+              and not is_budgeted(buff_size))
+    class basic_work_stealing_pool
+    // clang-format on
+    {
+      public:
+        using executor_type = Executor;
+        using queue_type = basic_channel<T, buff_size, channel_stream_mode::block_until_available, Executor, Mutex>;
+
+        explicit basic_work_stealing_pool(std::size_t const num_workers)
+          : state_{std::make_shared<state>(num_workers)}
+        {
+            assert(num_workers > 0);
+        }
+
+        [[nodiscard]] auto num_workers() const noexcept -> std::size_t
+        {
+            return state_->queues.size();
+        }
+
+        // Writes a value to the channels of the workers in turn.
+        [[nodiscard]] auto submit(T value) const -> asio::awaitable<void, Executor>
+        {
+            auto const worker = state_->next_worker.fetch_add(1, std::memory_order_relaxed) % num_workers();
+            return submit(worker, std::move(value));
+        }
+
+        [[nodiscard]] auto submit(std::size_t const worker, T value) const -> asio::awaitable<void, Executor>
+        {
+            assert(worker < num_workers());
+            return state_->queues[worker].write(std::move(value));
+        }
+
+        // Takes a value for the worker, stealing or waiting if its own channel is empty.
+        [[nodiscard]] auto read(std::size_t const worker) const -> asio::awaitable<T, Executor>
+        {
+            assert(worker < num_workers());
+            return read(state_, worker);
+        }
+
+        // Takes a value for the worker, stealing if its own channel is empty, without waiting.
+        [[nodiscard]] auto try_read(std::size_t const worker) const -> std::optional<T>
+        {
+            assert(worker < num_workers());
+            return try_take(*state_, worker);
+        }
+
+      private:
+        struct state
+        {
+            explicit state(std::size_t const num_workers)
+              : queues(num_workers)
+            {
+            }
+
+            std::vector<queue_type> queues;
+            std::atomic_size_t next_worker = 0;
+        };
+
+        // Holds the state by value, so the pool handle may be destroyed while the read is pending.
+        static auto read(std::shared_ptr<state> state, std::size_t const worker) -> asio::awaitable<T, Executor>
+        {
+            if (auto value = try_take(*state, worker))
+            {
+                co_return std::move(*value);
+            }
+
+            // Every channel is empty; take the first value written to any of them.
+            auto result = co_await select_range(state->queues);
+            co_return std::move(result).get();
+        }
+
+        static auto try_take(state& state, std::size_t const worker) -> std::optional<T>
+        {
+            if (auto value = state.queues[worker].try_read())
+            {
+                return value;
+            }
+
+            auto const num_workers = state.queues.size();
+            for (auto offset = std::size_t{1}; offset < num_workers; ++offset)
+            {
+                auto const victim = (worker + offset) % num_workers;
+                if (auto value = steal_half(state.queues[victim], state.queues[worker]))
+                {
+                    return value;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Moves half of the victim's buffered values, rounded up, to the thief and
+        // returns the first of them. The others go to readers waiting on the thief first.
+        // Waiters are only dequeued with their own channel locked: a pool reader waits on
+        // all queues, so claiming it unlinks its nodes from the other queue as well.
+        static auto steal_half(queue_type const& victim, queue_type const& thief) -> std::optional<T>
+        {
+            using shared_state_type = typename queue_type::shared_state_type;
+
+            auto& from = *victim.shared_state_ptr();
+            auto& to = *thief.shared_state_ptr();
+            auto wakeups = detail::wakeup_batch<Executor>{};
+            auto slot = detail::send_slot<T>{};
+            auto value = std::optional<T>{};
+            auto buffered = false;
+
+            {
+                auto const lock = std::scoped_lock{from.mutex(), to.mutex()};
+
+                auto const available = from.buffer().size();
+                if (available == 0)
+                {
+                    return std::nullopt;
+                }
+
+                from.buffer().dequeue(slot);
+                value.emplace(slot.read());
+
+                // Readers only wait on an empty queue, so the buffer has room for them.
+                for (auto moved = std::size_t{1}; moved < (available + 1) / 2 and not to.buffer().full(); ++moved)
+                {
+                    from.buffer().dequeue(slot);
+                    to.buffer().enqueue(slot);
+                    buffered = true;
+                }
+            }
+
+            if (buffered)
+            {
+                auto const lock = std::scoped_lock{to.mutex()};
+                while (not to.buffer().empty())
+                {
+                    auto const reader = to.reader_list().dequeue_first_available();
+                    if (not reader)
+                    {
+                        to.notify_readable();
+                        break;
+                    }
+
+                    to.buffer().dequeue(slot);
+                    transfer(slot, *reader->slot);
+                    wakeups.add(*reader);
+                }
+            }
+
+            if constexpr (not shared_state_type::write_never_waits)
+            {
+                // Writers blocked on the full victim can store their values now.
+                auto const lock = std::scoped_lock{from.mutex()};
+                from.refill_from_writers(wakeups);
+            }
+
+            return value;
+        }
+
+        std::shared_ptr<state> state_;
+    };
+
+    template <sendable T, channel_buff_size buff_size>
+    using work_stealing_pool = basic_work_stealing_pool<T, buff_size, asio::any_io_executor>;
+}  // namespace asiochan
@@ -3,6 +3,7 @@
 #include <array>
 #include <concepts>
 #include <cstddef>
+#include <memory>
 #include <optional>
 #include <type_traits>
 #include <utility>
@@ -10,8 +11,10 @@
 #include "asiochan/asio.hpp"
 #include "asiochan/channel_concepts.hpp"
 #include "asiochan/detail/channel_op_result_base.hpp"
+#include "asiochan/detail/channel_shared_state.hpp"
 #include "asiochan/detail/channel_waiter_list.hpp"
 #include "asiochan/detail/send_slot.hpp"
+#include "asiochan/detail/wakeup_batch.hpp"
 #include "asiochan/select_concepts.hpp"
 #include "asiochan/sendable.hpp"
 
@@ -84,6 +87,7 @@ namespace asiochan
                  { ([&]<typename ChannelState>(const ChannelState& channel_state)
                     {
                           constexpr auto channel_index = indices;
+                          auto wakeups = detail::wakeup_batch<executor_type>{};
                           auto const lock = std::scoped_lock{channel_state->mutex()};
 
                           if (auto const reader = channel_state->reader_list().dequeue_first_available())
@@ -91,17 +95,18 @@ namespace asiochan
                               // Buffer was empty with readers waiting.
                               // Wake the oldest reader and give him a value.
                               transfer(slot_, *reader->slot);
-                              detail::notify_waiter(*reader);
+                              wakeups.add(*reader);
                               ready_alternative = channel_index;
 
                               return true;
                           }
-                          else if constexpr (ChannelState::element_type::buff_size != 0)
+                          else if constexpr (std::pointer_traits<ChannelState>::element_type::buff_size != 0)
                           {
-                              if (ChannelState::element_type::forget_oldest or not channel_state->buffer().full())
+                              if (std::pointer_traits<ChannelState>::element_type::forget_oldest or not channel_state->buffer().full())
                               {
                                   // Store the value in the buffer.
                                   channel_state->buffer().enqueue(slot_);
+                                  channel_state->notify_readable();
                                   ready_alternative = channel_index;
 
                                   return true;
@@ -131,6 +136,7 @@ namespace asiochan
                              {
                                  constexpr auto channel_index = indices;
                                  auto const token = base_token + channel_index;
+                                 auto wakeups = detail::wakeup_batch<executor_type>{};
                                  auto const lock = std::scoped_lock{channel_state->mutex()};
 
                                  if (auto const reader = channel_state->reader_list().dequeue_first_available(select_ctx))
@@ -138,12 +144,12 @@ namespace asiochan
                                      // Buffer was empty with readers waiting.
                                      // Wake the oldest reader and give him a value.
                                      transfer(slot_, *reader->slot);
-                                     detail::notify_waiter(*reader);
+                                     wakeups.add(*reader);
                                      ready_alternative = channel_index;
 
                                      return true;
                                  }
-                                 else if constexpr (ChannelState::element_type::buff_size != 0)
+                                 else if constexpr (std::pointer_traits<ChannelState>::element_type::buff_size != 0)
                                  {
                                      if (not channel_state->buffer().full())
                                      {
@@ -151,6 +157,7 @@ namespace asiochan
                                          {
                                              // Store the value in the buffer.
                                              channel_state->buffer().enqueue(slot_);
+                                             channel_state->notify_readable();
                                              ready_alternative = channel_index;
                                          }
 
@@ -165,7 +172,8 @@ namespace asiochan
                                  waiter_node.token = token;
                                  waiter_node.next = nullptr;
 
-                                 channel_state->writer_list().enqueue(waiter_node);
+                                 detail::enqueue_waiter<detail::waiter_list_side::writers>(*channel_state, waiter_node);
+                                 channel_state->notify_readable();
 
                                  return false;
                              }(std::get<indices>(channels_).shared_state_ptr())
@@ -187,9 +195,11 @@ namespace asiochan
                           constexpr auto channel_index = indices;
                           auto& waiter_node = wait_state.waiter_nodes[channel_index];
 
-                          if (channel_index == successful_alternative or not waiter_node.has_value())
+                          if (channel_index == successful_alternative or not waiter_node.has_value()
+                              or not detail::still_linked(*waiter_node->ctx, *waiter_node))
                           {
-                              // No need to clear wait on a successful or unsubmitted sub-operation
+                              // No need to clear wait on a successful, unsubmitted or already
+                              // unlinked sub-operation
                               return;
                           }
 
@@ -223,7 +233,7 @@ namespace asiochan
             }
 
           private:
-            std::tuple<ChannelsHead&, ChannelsTail&...> channels_;
+            std::tuple<detail::op_channel_storage_t<ChannelsHead>, detail::op_channel_storage_t<ChannelsTail>...> channels_;
             [[no_unique_address]] mutable slot_type slot_;
         };
 
@@ -1,27 +1,56 @@
+#include <algorithm>
+#include <filesystem>
+#include <future>
+#include <memory>
 #include <numeric>
 #include <ranges>
+#include <span>
 #include <string>
 #include <atomic>
 
 #include <iostream>
 
 #include <asiochan/channel.hpp>
+#include <asiochan/channel_ref.hpp>
+#include <asiochan/channel_eventfd.hpp>
+#include <asiochan/channel_set.hpp>
+#include <asiochan/delay_channel.hpp>
+#include <asiochan/pipeline.hpp>
+#include <asiochan/rate_limited.hpp>
+#include <asiochan/remote.hpp>
+#include <asiochan/selector.hpp>
+#include <asiochan/sharded_channel.hpp>
+#include <asiochan/shm_channel.hpp>
+#include <asiochan/ticker.hpp>
+#include <asiochan/work_stealing_pool.hpp>
 #include "catch2/catch_all.hpp"
 
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #ifdef ASIOCHAN_USE_STANDALONE_ASIO
 
+#include <asio/bind_executor.hpp>
 #include <asio/co_spawn.hpp>
 #include <asio/detached.hpp>
 #include <asio/io_context.hpp>
+#include <asio/local/connect_pair.hpp>
+#include <asio/local/stream_protocol.hpp>
 #include <asio/thread_pool.hpp>
 #include <asio/use_future.hpp>
 #include <asio/steady_timer.hpp>
 
 #else
 
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/thread_pool.hpp>
 #include <boost/asio/use_future.hpp>
 #include <boost/asio/steady_timer.hpp>
@@ -99,236 +128,1823 @@ TEST_CASE("Channels")
     auto const num_threads = GENERATE(range(10u, 20u));
     auto thread_pool = asio::thread_pool{num_threads};
 
-    SECTION("Ping-pong")
-    {
-        auto channel = asiochan::channel<std::string>{};
+    SECTION("Ping-pong")
+    {
+        auto channel = asiochan::channel<std::string>{};
+
+        auto ping_task = asio::co_spawn(
+            thread_pool,
+            [channel]() -> asio::awaitable<void>
+            {
+                co_await channel.write("ping");
+                auto const recv = co_await channel.read();
+                CHECK(recv == "pong");
+            },
+            asio::use_future);
+
+        auto pong_task = asio::co_spawn(
+            thread_pool,
+            [channel]() -> asio::awaitable<void>
+            {
+                auto const recv = co_await channel.read();
+                CHECK(recv == "ping");
+                co_await channel.write("pong");
+            },
+            asio::use_future);
+
+        pong_task.get();
+        ping_task.get();
+    }
+
+    SECTION("Buffered channel")
+    {
+        static constexpr auto buffer_size = 3;
+
+        auto channel = asiochan::channel<int, buffer_size>{};
+        auto read_channel = asiochan::read_channel<int, buffer_size>{channel};
+        auto write_channel = asiochan::write_channel<int, buffer_size>{channel};
+
+        for (auto const i : std::views::iota(0, buffer_size))
+        {
+            auto const was_sent = write_channel.try_write(i);
+            CHECK(was_sent);
+        }
+        auto const last_was_sent = write_channel.try_write(0);
+        CHECK(not last_was_sent);
+
+        for (auto const i : std::views::iota(0, buffer_size))
+        {
+            auto const recv = read_channel.try_read();
+            REQUIRE(recv.has_value());
+            CHECK(*recv == i);
+        }
+        auto const last_recv = read_channel.try_read();
+        CHECK(not last_recv.has_value());
+    }
+
+    SECTION("Concurrence buffered channel")
+    {
+        static constexpr auto buffer_size = 1;
+
+        auto channel = asiochan::channel<int, buffer_size>{};
+        std::atomic_int sum {0};
+        for (size_t i = 0; i < 100; i++)
+        {
+            asio::co_spawn(
+                thread_pool,
+                [channel, i]() -> asio::awaitable<void>
+                {
+                    co_await channel.write(i);
+                },
+                asio::use_future);
+            asio::co_spawn(
+                thread_pool,
+                [channel, &sum]() -> asio::awaitable<void>
+                {
+                    auto i = co_await channel.read();
+                    ++sum;
+                },
+                asio::use_future);
+        }
+        thread_pool.join();
+        CHECK(sum.load() == 100);
+    }
+
+    SECTION("Buffered channel wraps around")
+    {
+        static constexpr auto buffer_size = 3;
+
+        auto const token = std::make_shared<int>(0);
+        {
+            auto channel = asiochan::channel<std::shared_ptr<int>, buffer_size>{};
+
+            for (auto const round : std::views::iota(0, 4))
+            {
+                for (auto const i : std::views::iota(0, buffer_size))
+                {
+                    CHECK(channel.try_write(token));
+                }
+                CHECK(not channel.try_write(token));
+                CHECK(token.use_count() == buffer_size + 1);
+
+                CHECK(channel.try_read() == token);
+                CHECK(channel.try_write(token));
+                for (auto const i : std::views::iota(0, buffer_size))
+                {
+                    CHECK(channel.try_read() == token);
+                }
+            }
+            CHECK(token.use_count() == 1);
+
+            // Values left in the buffer are destroyed with the channel.
+            CHECK(channel.try_write(token));
+            CHECK(token.use_count() == 2);
+        }
+        CHECK(token.use_count() == 1);
+    }
+
+    SECTION("Buffered channel of void")
+    {
+        static constexpr auto buffer_size = 3;
+
+        auto channel = asiochan::channel<void, buffer_size>{};
+        auto read_channel = asiochan::read_channel<void, buffer_size>{channel};
+        auto write_channel = asiochan::write_channel<void, buffer_size>{channel};
+
+        for (auto const i : std::views::iota(0, buffer_size))
+        {
+            auto const was_sent = write_channel.try_write();
+            CHECK(was_sent);
+        }
+        auto const last_was_sent = write_channel.try_write();
+        CHECK(not last_was_sent);
+
+        for (auto const i : std::views::iota(0, buffer_size))
+        {
+            auto const recv = read_channel.try_read();
+            CHECK(recv);
+        }
+        auto const last_recv = read_channel.try_read();
+        CHECK(not last_recv);
+    }
+
+    SECTION("Dynamic buffered channel")
+    {
+        using namespace asiochan;
+
+        auto channel = dynamic_channel<int>{2};
+        auto read_channel = dynamic_read_channel<int>{channel};
+        CHECK(channel.capacity() == 2);
+
+        CHECK(channel.try_write(0));
+        CHECK(channel.try_write(1));
+        CHECK(not channel.try_write(2));
+
+        channel.set_capacity(5);
+        CHECK(read_channel.capacity() == 5);
+        for (auto const i : std::views::iota(2, 5))
+        {
+            CHECK(channel.try_write(i));
+        }
+        CHECK(not channel.try_write(5));
+
+        // Shrinking keeps the buffered values, but blocks writers until they are drained.
+        channel.set_capacity(3);
+        for (auto const i : std::views::iota(0, 2))
+        {
+            CHECK(read_channel.try_read() == i);
+            CHECK(not channel.try_write(i));
+        }
+        CHECK(read_channel.try_read() == 2);
+        CHECK(channel.try_write(5));
+
+        auto writer = asio::co_spawn(
+            thread_pool,
+            [channel]() -> asio::awaitable<void>
+            {
+                co_await channel.write(6);
+            },
+            asio::use_future);
+        CHECK(writer.wait_for(std::chrono::milliseconds{10}) == std::future_status::timeout);
+
+        // Growing the buffer admits the waiting writer.
+        channel.set_capacity(4);
+        writer.get();
+
+        auto reader = asio::co_spawn(
+            thread_pool,
+            [read_channel]() -> asio::awaitable<std::vector<int>>
+            {
+                auto values = std::vector<int>{};
+                for (auto const i : std::views::iota(0, 4))
+                {
+                    auto result = co_await asiochan::select(asiochan::ops::read(read_channel));
+                    values.push_back(result.get_received<int>());
+                }
+                co_return values;
+            },
+            asio::use_future);
+        CHECK(reader.get() == std::vector{3, 4, 5, 6});
+
+        auto void_channel = dynamic_channel<void>{1};
+        CHECK(void_channel.try_write());
+        CHECK(not void_channel.try_write());
+        void_channel.set_capacity(2);
+        CHECK(void_channel.try_write());
+        CHECK(void_channel.try_read());
+        CHECK(void_channel.try_read());
+        CHECK(not void_channel.try_read());
+
+        auto unblocked = dynamic_channel<int, channel_stream_mode::forget_oldest>{3};
+        for (auto const i : std::views::iota(0, 5))
+        {
+            unblocked.write(i);
+        }
+        unblocked.set_capacity(2);
+        CHECK(unblocked.try_read() == 3);
+        CHECK(unblocked.try_read() == 4);
+        CHECK(not unblocked.try_read());
+
+        // A capacity of zero is rejected, and leaves the capacity as it was.
+        CHECK_THROWS_AS(dynamic_channel<int>{0}, std::invalid_argument);
+        CHECK_THROWS_AS(dynamic_channel<void>{0}, std::invalid_argument);
+        CHECK_THROWS_AS(unblocked.set_capacity(0), std::invalid_argument);
+        CHECK(unblocked.capacity() == 2);
+    }
+
+    SECTION("Byte budgeted channel")
+    {
+        using namespace asiochan;
+
+        auto channel = budgeted_channel<std::string>{byte_budget<std::string>{
+            .limit = 100,
+            .low_watermark = 40,
+            .size_of = [](std::string const& value) { return value.size(); },
+        }};
+        auto const& buffer = channel.shared_state().buffer();
+        auto const message = [](char const c) { return std::string(30, c); };
+
+        // Writes succeed until the budget is used up, even by a part of the last value.
+        for (auto const c : {'a', 'b', 'c', 'd'})
+        {
+            CHECK(channel.try_write(message(c)));
+        }
+        CHECK(buffer.used_bytes() == 120);
+        CHECK(not channel.try_write(message('e')));
+
+        auto writer = asio::co_spawn(
+            thread_pool,
+            [channel, message]() -> asio::awaitable<void>
+            {
+                co_await channel.write(message('e'));
+                co_await channel.write(message('f'));
+            },
+            asio::use_future);
+        CHECK(writer.wait_for(std::chrono::milliseconds{10}) == std::future_status::timeout);
+
+        // Writers stay blocked until usage drops below the low watermark.
+        CHECK(channel.try_read() == message('a'));
+        CHECK(channel.try_read() == message('b'));
+        CHECK(writer.wait_for(std::chrono::milliseconds{10}) == std::future_status::timeout);
+        CHECK(not channel.try_write(std::string{}));
+
+        CHECK(channel.try_read() == message('c'));
+        writer.get();
+        CHECK(buffer.used_bytes() == 90);
+
+        for (auto const c : {'d', 'e', 'f'})
+        {
+            CHECK(channel.try_read() == message(c));
+        }
+        CHECK(buffer.used_bytes() == 0);
+
+        // A value larger than the whole budget is still accepted by an empty channel.
+        CHECK(channel.try_write(std::string(500, 'g')));
+        CHECK(not channel.try_write(message('h')));
+        CHECK(channel.try_read() == std::string(500, 'g'));
+        CHECK(channel.try_write(message('h')));
+
+        auto unblocked = budgeted_channel<std::string, channel_stream_mode::forget_oldest>{byte_budget<std::string>{
+            .limit = 100,
+            .size_of = [](std::string const& value) { return value.size(); },
+        }};
+        for (auto const c : {'a', 'b', 'c', 'd', 'e'})
+        {
+            unblocked.write(message(c));
+        }
+        CHECK(unblocked.shared_state().buffer().used_bytes() == 90);
+        CHECK(unblocked.try_read() == message('c'));
+
+        CHECK_THROWS_AS(budgeted_channel<std::string>{byte_budget<std::string>{}}, std::invalid_argument);
+        CHECK_THROWS_AS(
+            (budgeted_channel<std::string>{byte_budget<std::string>{.limit = 10, .low_watermark = 20}}),
+            std::invalid_argument);
+    }
+
+    SECTION("Unbounded buffered channel")
+    {
+        static constexpr auto num_tokens = 10;
+
+        auto channel = asiochan::unbounded_channel<int>{};
+        auto read_channel = asiochan::unbounded_read_channel<int>{channel};
+        auto write_channel = asiochan::unbounded_write_channel<int>{channel};
+
+        for (auto const i : std::views::iota(0, num_tokens))
+        {
+            write_channel.write(i);
+        }
+
+        for (auto const i : std::views::iota(0, num_tokens))
+        {
+            auto const recv = read_channel.try_read();
+            CHECK(recv == i);
+        }
+        auto const last_recv = read_channel.try_read();
+        CHECK(not last_recv.has_value());
+    }
+
+#if defined(ASIOCHAN_HAS_SPILL)
+    SECTION("Spilling unbounded channel")
+    {
+        auto const directory = std::filesystem::temp_directory_path() / "asiochan-spill-test";
+        std::filesystem::create_directories(directory);
+
+        auto channel = asiochan::unbounded_channel<int>{asiochan::spill_options{
+            .directory = directory,
+            .memory_limit = 4,
+            .segment_size = 8,
+        }};
+        auto const& buffer = channel.shared_state().buffer();
+
+        auto next_write = 0;
+        auto next_read = 0;
+        for (; next_write < 50; ++next_write)
+        {
+            channel.write(next_write);
+        }
+        CHECK(buffer.size() == 50);
+        CHECK(buffer.spilled() == 46);
+        CHECK(std::filesystem::is_empty(directory));
+
+        // Spilled values move back to memory as readers catch up, and later values stay
+        // behind them.
+        for (; next_read < 30; ++next_read)
+        {
+            CHECK(channel.try_read() == next_read);
+        }
+        CHECK(buffer.spilled() == 16);
+        for (; next_write < 60; ++next_write)
+        {
+            channel.write(next_write);
+        }
+        CHECK(buffer.spilled() == 26);
+
+        for (; next_read < 60; ++next_read)
+        {
+            CHECK(channel.try_read() == next_read);
+        }
+        CHECK(not channel.try_read().has_value());
+        CHECK(buffer.spilled() == 0);
+
+        // Without spilled values, writes go to memory again.
+        channel.write(next_write);
+        CHECK(buffer.spilled() == 0);
+        CHECK(channel.try_read() == next_write);
+
+        // A value that cannot be spilled is not written.
+        auto failing = asiochan::unbounded_channel<int>{asiochan::spill_options{
+            .directory = directory / "missing",
+            .memory_limit = 1,
+            .segment_size = 8,
+        }};
+        failing.write(1);
+        CHECK_THROWS_AS(failing.write(2), std::system_error);
+        CHECK(failing.shared_state().buffer().size() == 1);
+        CHECK(failing.try_read() == 1);
+        failing.write(3);
+        CHECK(failing.try_read() == 3);
+
+        std::filesystem::remove(directory);
+    }
+#endif
+
+    SECTION("Single operations")
+    {
+        using namespace asiochan;
+        auto ioc = asio::io_context{};
+        auto const buffered = channel<int, 1>{};
+        auto const unbuffered = channel<int>{};
+        auto ready_value = std::optional<int>{};
+
+        // Ready operations complete without suspending the coroutine.
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void>
+            {
+                co_await buffered.write(1);
+                ready_value = co_await buffered.read();
+            },
+            asio::detached);
+        CHECK(ioc.run_one() == 1);
+        CHECK(ready_value == 1);
+
+        // Waiting operations wake each other.
+        ioc.restart();
+        auto reader = asio::co_spawn(ioc, unbuffered.read(), asio::use_future);
+        asio::co_spawn(ioc, unbuffered.write(2), asio::detached);
+        ioc.run();
+        CHECK(reader.get() == 2);
+        CHECK(unbuffered.shared_state_ptr()->reader_list().empty());
+        CHECK(unbuffered.shared_state_ptr()->writer_list().empty());
+    }
+
+    SECTION("Completion tokens")
+    {
+        using namespace asiochan;
+        auto ioc = asio::io_context{};
+        auto const ints = channel<int>{};
+        auto const signals = channel<void, 1>{};
+
+        // Callbacks run on their associated executor, without a coroutine.
+        auto received = std::optional<int>{};
+        auto sent = false;
+        ints.async_read(asio::bind_executor(ioc, [&](int const value) { received = value; }));
+        ints.async_write(1, asio::bind_executor(ioc, [&]() { sent = true; }));
+        ioc.run();
+        CHECK(received == 1);
+        CHECK(sent);
+
+        // Ready operations complete without waiting.
+        signals.async_write(asio::use_future).get();
+        signals.async_read(asio::use_future).get();
+
+        auto selected = async_select(ops::read(ints), ops::read(signals), asio::use_future);
+        signals.write_sync();
+        CHECK(selected.get().received_from(signals));
+
+        // Coroutines can still await them.
+        ioc.restart();
+        auto awaited = asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<int>
+            {
+                co_return co_await ints.async_read(asio::use_awaitable);
+            },
+            asio::use_future);
+        ioc.poll();
+        ints.write_sync(2);
+        ioc.run();
+        CHECK(awaited.get() == 2);
+
+        // Waiting operations keep the channel alive after its handle is dropped.
+        auto late_read = std::future<int>{};
+        auto const writer = [&]()
+        {
+            auto const dropped = channel<int>{};
+            late_read = dropped.async_read(asio::use_future);
+            return write_channel<int>{dropped};
+        }();
+        CHECK(writer.shared_state_ptr().use_count() == 2);
+        writer.write_sync(4);
+        CHECK(late_read.get() == 4);
+
+        auto late_write = std::future<void>{};
+
+        auto const reader = [&]()
+        {
+            auto const dropped = channel<int>{};
+            late_write = dropped.async_write(5, asio::use_future);
+            return read_channel<int>{dropped};
+        }();
+        CHECK(reader.shared_state_ptr().use_count() == 2);
+        CHECK(reader.read_sync() == 5);
+        late_write.get();
+        CHECK(reader.shared_state_ptr().use_count() == 1);
+
+        // Concurrent waiting readers and writers.
+        constexpr auto num_values = 1000;
+        auto sum = std::atomic_int{0};
+        auto readers = std::vector<std::future<int>>{};
+        for (auto i = 0; i < num_values; ++i)
+        {
+            readers.push_back(ints.async_read(asio::use_future));
+        }
+        auto writers = std::vector<std::future<void>>{};
+        for (auto i = 0; i < num_values; ++i)
+        {
+            writers.push_back(ints.async_write(i, asio::use_future));
+        }
+        for (auto& reader : readers)
+        {
+            sum += reader.get();
+        }
+        for (auto& writer : writers)
+        {
+            writer.get();
+        }
+        CHECK(sum == num_values * (num_values - 1) / 2);
+        CHECK(ints.shared_state_ptr()->reader_list().empty());
+        CHECK(ints.shared_state_ptr()->writer_list().empty());
+    }
+
+    SECTION("Channel handles")
+    {
+        using namespace asiochan;
+
+        // Handles count their references in the shared state.
+        auto channel = asiochan::channel<int, 1>{};
+        CHECK(channel.shared_state_ptr().use_count() == 1);
+        {
+            auto const copy = channel;
+            auto const read_only = read_channel<int, 1>{channel};
+            CHECK(channel.shared_state_ptr().use_count() == 3);
+            CHECK(copy == channel);
+        }
+        CHECK(channel.shared_state_ptr().use_count() == 1);
+
+        auto local = basic_channel<int, 1, channel_stream_mode::block_until_available, asio::any_io_executor, null_mutex>{};
+        {
+            auto const copy = local;
+            CHECK(local.shared_state_ptr().use_count() == 2);
+            CHECK(copy.try_write(1));
+        }
+        CHECK(local.shared_state_ptr().use_count() == 1);
+        CHECK(local.try_read() == 1);
+
+        // Borrowed handles leave the count alone.
+        auto const ref = channel_ref{channel};
+        CHECK(channel.shared_state_ptr().use_count() == 1);
+        CHECK(ref.try_write(1));
+        CHECK(channel.try_read() == 1);
+
+        auto reader = asio::co_spawn(
+            thread_pool,
+            [](channel_ref<asiochan::channel<int, 1>> const in) -> asio::awaitable<std::optional<int>>
+            {
+                auto const result = co_await select(ops::read(in));
+                if (auto const value = result.get_if_received_from(in))
+                {
+                    co_return *value;
+                }
+                co_return std::nullopt;
+            }(channel),
+            asio::use_future);
+        CHECK(ref.try_write(2));
+        CHECK(reader.get() == 2);
+        CHECK(channel.shared_state_ptr().use_count() == 1);
+    }
+
+    SECTION("Channel of channel")
+    {
+        using CH0 = asiochan::channel<int>;
+        asiochan::channel<CH0> ch_of_ch0;
+    }
+
+    SECTION("Multiple writers and receivers")
+    {
+        static constexpr auto num_tokens_per_task = 5;
+        static constexpr auto num_tasks = 3;
+
+        auto channel = asiochan::channel<int>{};
+        auto read_channel = asiochan::read_channel<int>{channel};
+        auto write_channel = asiochan::write_channel<int>{channel};
+
+        auto source_values = std::vector<int>(num_tasks * num_tokens_per_task);
+        std::iota(source_values.begin(), source_values.end(), 0);
+
+        auto source_tasks = std::vector<std::future<void>>{};
+        for (auto const task_id : std::views::iota(0, num_tasks))
+        {
+            source_tasks.push_back(
+                asio::co_spawn(
+                    thread_pool,
+                    [write_channel, task_id, &source_values]() -> asio::awaitable<void>
+                    {
+                        auto const start = task_id * num_tokens_per_task;
+                        for (auto const i : std::views::iota(start, start + num_tokens_per_task))
+                        {
+                            co_await write_channel.write(source_values[i]);
+                        }
+                    },
+                    asio::use_future));
+        }
+
+        auto sink_values = std::vector<int>(num_tasks * num_tokens_per_task);
+        auto sink_tasks = std::vector<std::future<void>>{};
+        for (auto const task_id : std::views::iota(0, num_tasks))
+        {
+            sink_tasks.push_back(
+                asio::co_spawn(
+                    thread_pool,
+                    [read_channel, task_id, &sink_values]() -> asio::awaitable<void>
+                    {
+                        auto const start = task_id * num_tokens_per_task;
+                        for (auto const i : std::views::iota(start, start + num_tokens_per_task))
+                        {
+                            sink_values[i] = co_await read_channel.read();
+                        }
+                    },
+                    asio::use_future));
+        }
+
+        for (auto& sink_task : sink_tasks)
+        {
+            sink_task.get();
+        }
+
+        std::ranges::sort(sink_values);
+        CHECK(source_values == sink_values);
+
+        for (auto& source_task : source_tasks)
+        {
+            source_task.get();
+        }
+    }
+
+    SECTION("Make sure crash when channel_waiter_list.dequeue not happen again")
+    {
+        using namespace asiochan;
+        auto task = asio::co_spawn(
+            thread_pool,
+            []() -> asio::awaitable<void>
+            {
+                auto executor = co_await asio::this_coro::executor;
+                channel<int, 1> ch {};
+                for (size_t i = 0; i < 2; i++)
+                {
+                    unbounded_channel<void> res {};
+                    for (size_t i = 0; i < 3; i++)
+                    {
+                        asio::co_spawn(executor, [ch, res]() -> asio::awaitable<void>{
+                            auto executor = co_await asio::this_coro::executor;
+                            auto timeouter = make_timeout(std::chrono::milliseconds(30), executor);
+                            co_await asiochan::select(
+                                asiochan::ops::read(timeouter),
+                                asiochan::ops::read(ch)
+                            );
+                            res.write();
+                        }, asio::detached);
+                    }
+                    for (size_t i = 0; i < 3; i++)
+                    {
+                        co_await res.read();
+                    }
+                }
+            },
+            asio::use_future
+        );
+        task.get();
+    }
+
+    SECTION("Select over a range of channels")
+    {
+        using namespace asiochan;
+        auto const num_channels = GENERATE(3u, 20u);
+
+        auto channels = std::vector<channel<int>>(num_channels);
+        auto read_channels = std::vector<read_channel<int>>(channels.begin(), channels.end());
+        auto const target = num_channels - 2;
+
+        auto const ready = select_ready(ops::read_any(read_channels), ops::nothing);
+        CHECK(not ready.has_value());
+
+        auto reader = asio::co_spawn(
+            thread_pool,
+            [&read_channels]() -> asio::awaitable<std::pair<std::size_t, int>>
+            {
+                auto result = co_await select_range(read_channels);
+                CHECK(result.matches(read_channels[result.index()]));
+                co_return std::pair{result.index(), result.get()};
+            },
+            asio::use_future);
+
+        asio::co_spawn(
+            thread_pool,
+            [channel = channels[target]]() -> asio::awaitable<void>
+            {
+                co_await channel.write(42);
+            },
+            asio::detached);
+
+        CHECK(reader.get() == std::pair{std::size_t{target}, 42});
+
+        auto buffered = std::vector<channel<void, 1>>(num_channels);
+        CHECK(buffered[target].try_write());
+        auto timeout = channel<void>{};
+        auto task = asio::co_spawn(
+            thread_pool,
+            [&buffered, timeout]() -> asio::awaitable<std::size_t>
+            {
+                auto result = co_await select(
+                    ops::read(timeout),
+                    ops::read_any(buffered));
+                co_return result.get<read_any_result<void>>().index();
+            },
+            asio::use_future);
+        CHECK(task.get() == target);
+
+        // Ranges must hold between one and read_any_max_channels channels.
+        auto none = std::vector<channel<int>>{};
+        CHECK_THROWS_AS(ops::read_any(none), std::invalid_argument);
+        auto too_many = std::vector<channel<void>>(ops::read_any_max_channels + 1);
+        CHECK_THROWS_AS(ops::read_any(too_many), std::length_error);
+        CHECK_NOTHROW(ops::read_any(std::span{too_many}.first(ops::read_any_max_channels)));
+    }
+
+    SECTION("Channel set")
+    {
+        using namespace asiochan;
+
+        auto buffered = channel<int, 4>{};
+        auto unbuffered = channel<int>{};
+        auto unbounded = unbounded_channel<int>{};
+        auto prefilled = channel<int, 1>{};
+        CHECK(prefilled.try_write(0));
+
+        auto set = channel_set{};
+        auto const buffered_key = set.add(read_channel<int, 4>{buffered});
+        auto const unbuffered_key = set.add(unbuffered);
+        auto const unbounded_key = set.add(unbounded);
+        auto const prefilled_key = set.add(prefilled);
+        CHECK(set.size() == 4);
+
+        CHECK(set.try_wait_ready() == std::vector{prefilled_key});
+        CHECK(set.try_wait_ready().empty());
+
+        CHECK(buffered.try_write(1));
+        CHECK(buffered.try_write(2));
+        unbounded.write(3);
+
+        auto const ready = asio::co_spawn(thread_pool, set.wait_ready(), asio::use_future).get();
+        CHECK(ready == std::vector{buffered_key, unbounded_key});
+        CHECK(buffered.try_read() == 1);
+        CHECK(buffered.try_read() == 2);
+        CHECK(unbounded.try_read() == 3);
+
+        auto waiter = asio::co_spawn(thread_pool, set.wait_ready(), asio::use_future);
+        asio::co_spawn(
+            thread_pool,
+            [unbuffered]() -> asio::awaitable<void>
+            {
+                co_await unbuffered.write(4);
+            },
+            asio::detached);
+        CHECK(waiter.get() == std::vector{unbuffered_key});
+        CHECK(unbuffered.read_sync() == 4);
+
+        set.remove(unbounded_key);
+        unbounded.write(5);
+        CHECK(set.try_wait_ready().empty());
+        CHECK(set.size() == 3);
+
+        // A channel is observed by one set at a time.
+        CHECK_THROWS_AS(set.add(buffered), std::logic_error);
+        CHECK(set.size() == 3);
+
+        // A channel that left the set can join another one.
+        auto other_set = channel_set{};
+        auto const other_key = other_set.add(unbounded);
+        CHECK(other_set.try_wait_ready() == std::vector{other_key});
+    }
+
+#if defined(__linux__)
+    SECTION("Channel eventfd")
+    {
+        using namespace asiochan;
+
+        auto const fd_ready = [](int const fd)
+        {
+            auto entry = ::pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+            return ::poll(&entry, 1, 0) == 1;
+        };
+
+        auto const chan = channel<int, 2>{};
+        auto bridge = channel_eventfd{chan};
+
+        // An empty bounded channel starts out writable.
+        CHECK(not fd_ready(bridge.readable_fd()));
+        CHECK(fd_ready(bridge.writable_fd()));
+        bridge.consume_writable();
+        CHECK(not fd_ready(bridge.writable_fd()));
+
+        // Several writes signal once, until the event is consumed.
+        CHECK(chan.try_write(1));
+        CHECK(chan.try_write(2));
+        CHECK(fd_ready(bridge.readable_fd()));
+        auto count = ::eventfd_t{};
+        CHECK(::eventfd_read(bridge.readable_fd(), &count) == 0);
+        CHECK(count == 1);
+        bridge.consume_readable();
+        CHECK(not fd_ready(bridge.readable_fd()));
+
+        // Reading from the full channel makes it writable again.
+        CHECK(chan.try_read() == 1);
+        CHECK(fd_ready(bridge.writable_fd()));
+        CHECK(chan.try_read() == 2);
+        bridge.consume_writable();
+
+        CHECK(chan.try_write(3));
+        CHECK(fd_ready(bridge.readable_fd()));
+        CHECK(chan.try_read() == 3);
+        CHECK_THROWS_AS(channel_eventfd{chan}, std::logic_error);
+
+        // An unbuffered channel becomes writable while a reader waits.
+        auto const unbuffered = channel<int>{};
+        auto unbuffered_bridge = channel_eventfd{unbuffered};
+        CHECK(not fd_ready(unbuffered_bridge.writable_fd()));
+        auto context = asio::io_context{};
+        auto reader = asio::co_spawn(context, unbuffered.read(), asio::use_future);
+        context.poll();
+        CHECK(fd_ready(unbuffered_bridge.writable_fd()));
+        CHECK(unbuffered.try_write(4));
+        context.poll();
+        CHECK(reader.get() == 4);
+    }
+#endif
+
+    SECTION("Persistent selector")
+    {
+        using namespace asiochan;
+        constexpr auto num_writes = 200;
+
+        auto first = channel<int>{};
+        auto second = channel<int, 2>{};
+        auto others = std::vector<channel<int>>(5);
+
+        auto const write_all = [&](int const tag, auto const& channel)
+        {
+            return asio::co_spawn(
+                thread_pool,
+                [tag, channel]() -> asio::awaitable<void>
+                {
+                    for (auto i = 1; i <= num_writes; ++i)
+                    {
+                        co_await channel.write(tag * i);
+                    }
+                },
+                asio::use_future);
+        };
+        auto first_writer = write_all(1, first);
+        auto others_writer = write_all(3, others[3]);
+        auto second_writer = write_all(2, second);
+
+        // A plain reader competing with the selector for the values of the second channel.
+        auto competitor = asio::co_spawn(
+            thread_pool,
+            [second]() -> asio::awaitable<int>
+            {
+                auto sum = 0;
+                for (auto value = co_await second.read(); value != -1; value = co_await second.read())
+                {
+                    sum += value;
+                }
+                co_return sum;
+            },
+            asio::use_future);
+
+        auto task = asio::co_spawn(
+            thread_pool,
+            [&]() -> asio::awaitable<int>
+            {
+                auto sel = selector{ops::read(first, second), ops::read_any(others)};
+                auto sum = 0;
+                auto pending = 2 * num_writes;
+                while (pending != 0)
+                {
+                    auto const result = co_await sel.wait();
+                    if (auto const* const any = result.get_if<read_any_result<int>>())
+                    {
+                        CHECK(any->index() == 3);
+                        sum += any->get();
+                        --pending;
+                    }
+                    else
+                    {
+                        auto const& received = result.get<read_result<int>>();
+                        sum += received.get();
+                        pending -= received.matches(first) ? 1 : 0;
+                    }
+                }
+                co_return sum;
+            },
+            asio::use_future);
+
+        auto const selected_sum = task.get();
+        first_writer.get();
+        others_writer.get();
+        second_writer.get();
+        second.write_sync(-1);
+
+        CHECK(selected_sum + competitor.get() == 6 * num_writes * (num_writes + 1) / 2);
+    }
+
+    SECTION("Pipeline stages")
+    {
+        using namespace asiochan;
+        using stream = channel<std::optional<int>>;
+        constexpr auto num_values = 500;
+
+        auto const executor = thread_pool.get_executor();
+        auto const feed = [](stream const& in, int const count)
+        {
+            for (auto i = 1; i <= count; ++i)
+            {
+                in.write_sync(i);
+            }
+            in.write_sync(std::nullopt);
+        };
+        auto const drain = [](auto const& out)
+        {
+            auto values = std::vector<int>{};
+            while (auto value = out.read_sync())
+            {
+                values.push_back(*value);
+            }
+            return values;
+        };
+        auto expected = std::vector<int>(num_values);
+        std::iota(expected.begin(), expected.end(), 1);
+
+        // Ordered parallel_map after map keeps the input order.
+        auto source = stream{};
+        auto shifted = channel<std::optional<int>, 16>{};
+        auto ordered = unbounded_channel<std::optional<int>>{};
+        stages::map(executor, read_channel<std::optional<int>>{source}, shifted, [](int x) { return x - 1; });
+        stages::parallel_map(executor, shifted, ordered, 4, [](int x) { return x + 1; });
+        feed(source, num_values);
+        CHECK(drain(ordered) == expected);
+
+        // Unordered parallel_map delivers every value once.
+        auto unordered_in = stream{};
+        auto unordered_out = stream{};
+        stages::parallel_map(executor, unordered_in, unordered_out, 3, [](int x) { return x; }, false);
+        auto reader = std::async(std::launch::async, drain, unordered_out);
+        feed(unordered_in, num_values);
+        auto unordered = reader.get();
+        std::ranges::sort(unordered);
+        CHECK(unordered == expected);
+
+        // flat_map, filter, and tee followed by merge.
+        auto flat_in = stream{};
+        auto repeated = stream{};
+        auto odd = stream{};
+        auto copies = std::vector<stream>(2);
+        auto merged = unbounded_channel<std::optional<int>>{};
+        stages::flat_map(executor, flat_in, repeated, [](int x) { return std::vector<int>(x, x); });
+        stages::filter(executor, repeated, odd, [](int x) { return x % 2 == 1; });
+        stages::tee(executor, odd, copies);
+        stages::merge(executor, copies, merged);
+        feed(flat_in, 5);
+        auto tail = drain(merged);
+        CHECK(tail.size() == 2 * (1 + 3 + 5));
+        CHECK(std::accumulate(tail.begin(), tail.end(), 0) == 2 * (1 + 9 + 25));
+
+        // A throwing function ends the output of its stage.
+        auto const throw_at_three = [](int x)
+        {
+            if (x == 3)
+            {
+                throw std::runtime_error{"three"};
+            }
+            return x;
+        };
+        auto throwing_in = unbounded_channel<std::optional<int>>{};
+        auto throwing_out = unbounded_channel<std::optional<int>>{};
+        stages::map(executor, throwing_in, throwing_out, throw_at_three);
+        for (auto i = 1; i <= 5; ++i)
+        {
+            throwing_in.write(i);
+        }
+        CHECK(drain(throwing_out) == std::vector{1, 2});
+
+        auto parallel_in = unbounded_channel<std::optional<int>>{};
+        auto parallel_out = unbounded_channel<std::optional<int>>{};
+        stages::parallel_map(executor, parallel_in, parallel_out, 2, throw_at_three, false);
+        for (auto i = 1; i <= num_values; ++i)
+        {
+            parallel_in.write(i);
+        }
+        parallel_in.write(std::nullopt);
+        auto partial = drain(parallel_out);
+        CHECK(std::ranges::find(partial, 3) == partial.end());
+        CHECK(partial.size() < num_values);
+    }
+
+    SECTION("Batch stage")
+    {
+        using namespace asiochan;
+        using namespace std::literals;
+
+        auto in = channel<std::optional<int>>{};
+        auto out = unbounded_channel<std::optional<std::vector<int>>>{};
+        auto returns = unbounded_channel<std::vector<int>>{};
+        stages::batch(thread_pool.get_executor(), in, out, 4, 50ms, returns);
+
+        for (auto i = 1; i <= 10; ++i)
+        {
+            in.write_sync(i);
+        }
+
+        // Full batches are written right away, the rest after the delay.
+        CHECK(out.read_sync() == std::vector{1, 2, 3, 4});
+        CHECK(out.read_sync() == std::vector{5, 6, 7, 8});
+        auto const start = std::chrono::steady_clock::now();
+        auto partial = *out.read_sync();
+        CHECK(partial == std::vector{9, 10});
+        CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+
+        // The next batch reuses the returned vector.
+        auto const* const storage = partial.data();
+        returns.write(std::move(partial));
+        in.write_sync(11);
+        in.write_sync(std::nullopt);
+        auto last = *out.read_sync();
+        CHECK(last == std::vector{11});
+        CHECK(last.data() == storage);
+        CHECK(out.read_sync() == std::nullopt);
+    }
+
+    SECTION("Remote streams")
+    {
+        using namespace asiochan;
+        using socket_type = asio::local::stream_protocol::socket;
+
+        // Strings are sent as their characters.
+        struct string_codec
+        {
+            static void encode(std::string const& value, std::vector<std::byte>& out)
+            {
+                auto const bytes = std::as_bytes(std::span{value});
+                out.insert(out.end(), bytes.begin(), bytes.end());
+            }
+
+            [[nodiscard]] static auto decode(std::span<std::byte const> const bytes) -> std::string
+            {
+                return {reinterpret_cast<char const*>(bytes.data()), bytes.size()};
+            }
+        };
+
+        auto context = asio::io_context{};
+        auto sender_socket = socket_type{context};
+        auto receiver_socket = socket_type{context};
+        asio::local::connect_pair(sender_socket, receiver_socket);
+
+        constexpr auto num_values = 1000;
+        auto const local = channel<std::optional<std::string>, 16>{};
+        auto const remote_end = channel<std::optional<std::string>, 4>{};
+        asio::co_spawn(context, remote::send(std::move(sender_socket), local, string_codec{}), asio::detached);
+        asio::co_spawn(context, remote::receive(std::move(receiver_socket), remote_end, string_codec{}), asio::detached);
+
+        asio::co_spawn(
+            context,
+            [local]() -> asio::awaitable<void>
+            {
+                for (auto i = 0; i < num_values; ++i)
+                {
+                    co_await local.write(std::to_string(i));
+                }
+                co_await local.write(std::nullopt);
+            },
+            asio::detached);
+
+        auto received = asio::co_spawn(
+            context,
+            [remote_end]() -> asio::awaitable<std::vector<std::string>>
+            {
+                auto values = std::vector<std::string>{};
+                while (auto value = co_await remote_end.read())
+                {
+                    values.push_back(std::move(*value));
+                }
+                co_return values;
+            },
+            asio::use_future);
+        context.run();
+
+        auto const values = received.get();
+        REQUIRE(values.size() == num_values);
+        for (auto i = 0; i < num_values; ++i)
+        {
+            CHECK(values[i] == std::to_string(i));
+        }
+
+        // The sender reads credits and writes values on several threads at once.
+        context.restart();
+        auto threaded_sender = socket_type{context};
+        auto threaded_receiver = socket_type{context};
+        asio::local::connect_pair(threaded_sender, threaded_receiver);
+        auto const threaded_local = channel<std::optional<int>, 16>{};
+        auto const threaded_remote = channel<std::optional<int>, 2>{};
+        asio::co_spawn(context, remote::send(std::move(threaded_sender), threaded_local), asio::detached);
+        asio::co_spawn(context, remote::receive(std::move(threaded_receiver), threaded_remote), asio::detached);
+        asio::co_spawn(
+            context,
+            [threaded_local]() -> asio::awaitable<void>
+            {
+                for (auto i = 1; i <= num_values; ++i)
+                {
+                    co_await threaded_local.write(i);
+                }
+                co_await threaded_local.write(std::nullopt);
+            },
+            asio::detached);
+        auto threaded_sum = asio::co_spawn(
+            context,
+            [threaded_remote]() -> asio::awaitable<int>
+            {
+                auto sum = 0;
+                while (auto const value = co_await threaded_remote.read())
+                {
+                    sum += *value;
+                }
+                co_return sum;
+            },
+            asio::use_future);
+        auto runners = std::vector<std::thread>{};
+        for (auto i = 0; i < 4; ++i)
+        {
+            runners.emplace_back([&context] { context.run(); });
+        }
+        for (auto& runner : runners)
+        {
+            runner.join();
+        }
+        CHECK(threaded_sum.get() == num_values * (num_values + 1) / 2);
+
+        // A closed connection ends the receiving stream.
+        context.restart();
+        auto closing_socket = socket_type{context};
+        auto remaining_socket = socket_type{context};
+        asio::local::connect_pair(closing_socket, remaining_socket);
+        auto const numbers = channel<std::optional<int>, 1>{};
+        asio::co_spawn(context, remote::receive(std::move(remaining_socket), numbers), asio::detached);
+        closing_socket.close();
+        auto ended = asio::co_spawn(context, numbers.read(), asio::use_future);
+        context.run();
+        CHECK(ended.get() == std::nullopt);
+
+        // Frames of the wrong size, or longer than the limit, are rejected.
+        auto const short_frame = std::array<std::byte, 2>{};
+        CHECK_THROWS_AS(trivial_codec<int>::decode(short_frame), system::system_error);
+
+        context.restart();
+        auto flooding_socket = socket_type{context};
+        auto limited_socket = socket_type{context};
+        asio::local::connect_pair(flooding_socket, limited_socket);
+        auto const limited = channel<std::optional<int>, 1>{};
+        auto rejected = asio::co_spawn(
+            context,
+            remote::receive(std::move(limited_socket), limited, trivial_codec<int>{}, 1, 64),
+            asio::use_future);
+        auto const huge_header = detail::encode_u32(1u << 30);
+        asio::write(flooding_socket, asio::buffer(huge_header));
+        auto limit_ended = asio::co_spawn(context, limited.read(), asio::use_future);
+        context.run();
+        CHECK_THROWS_AS(rejected.get(), system::system_error);
+        CHECK(limit_ended.get() == std::nullopt);
+    }
+
+    SECTION("Work stealing pool")
+    {
+        using namespace asiochan;
+
+        auto pool = work_stealing_pool<int, 8>{2};
+        asio::co_spawn(
+            thread_pool,
+            [pool]() -> asio::awaitable<void>
+            {
+                for (auto i = 0; i < 8; ++i)
+                {
+                    co_await pool.submit(0, i);
+                }
+            },
+            asio::use_future)
+            .get();
+
+        // An idle worker steals half of the other worker's values at once.
+        CHECK(pool.try_read(1) == 0);
+        CHECK(pool.try_read(1) == 1);
+        CHECK(pool.try_read(1) == 2);
+        CHECK(pool.try_read(1) == 3);
+        CHECK(pool.try_read(0) == 4);
+        CHECK(pool.try_read(1) == 5);
+        CHECK(pool.try_read(0) == 7);
+        CHECK(pool.try_read(0) == 6);
+        CHECK(pool.try_read(0) == std::nullopt);
+        CHECK(pool.try_read(1) == std::nullopt);
+
+        constexpr auto num_workers = 4u;
+        constexpr auto num_values = 2000;
+        auto busy_pool = work_stealing_pool<int, 16>{num_workers};
+        auto processed = std::make_shared<std::atomic_int>(0);
+        auto all_processed = channel<void, 1>{};
+        auto workers = std::vector<std::future<long long>>{};
+        for (auto worker = 0u; worker < num_workers; ++worker)
+        {
+            workers.push_back(asio::co_spawn(
+                thread_pool,
+                [busy_pool, worker, processed, all_processed]() -> asio::awaitable<long long>
+                {
+                    auto sum = 0ll;
+                    for (auto value = co_await busy_pool.read(worker); value >= 0; value = co_await busy_pool.read(worker))
+                    {
+                        sum += value;
+                        if (processed->fetch_add(1) + 1 == num_values)
+                        {
+                            co_await all_processed.write();
+                        }
+                    }
+                    co_return sum;
+                },
+                asio::use_future));
+        }
+
+        // All values go to the first worker, the others have to steal them.
+        asio::co_spawn(
+            thread_pool,
+            [busy_pool, all_processed]() -> asio::awaitable<void>
+            {
+                for (auto i = 1; i <= num_values; ++i)
+                {
+                    co_await busy_pool.submit(0, i);
+                }
+                co_await all_processed.read();
+                for (auto worker = 0u; worker < num_workers; ++worker)
+                {
+                    co_await busy_pool.submit(-1);
+                }
+            },
+            asio::detached);
+
+        auto total = 0ll;
+        for (auto& worker : workers)
+        {
+            total += worker.get();
+        }
+        CHECK(total == static_cast<long long>(num_values) * (num_values + 1) / 2);
+    }
+
+    SECTION("Rate limited channel")
+    {
+        using namespace std::chrono_literals;
+
+        auto channel = asiochan::unbounded_channel<int>{};
+        for (auto const i : std::views::iota(0, 20))
+        {
+            channel.write(i);
+        }
+
+        // 10 reads per 100ms, 3 of them in a burst.
+        auto limited = asiochan::rate_limited{
+            thread_pool.get_executor(),
+            channel,
+            asiochan::rate_limit{.count = 10, .period = 100ms, .burst = 3}};
+
+        auto const start = std::chrono::steady_clock::now();
+        for (auto const i : std::views::iota(0, 3))
+        {
+            CHECK(limited.try_read() == i);
+        }
+        CHECK(not limited.try_read().has_value());
+
+        auto reader = asio::co_spawn(
+            thread_pool,
+            [limited]() -> asio::awaitable<std::vector<int>>
+            {
+                auto values = std::vector<int>{};
+                for (auto const i : std::views::iota(0, 5))
+                {
+                    values.push_back(co_await limited.read());
+                }
+                co_return values;
+            },
+            asio::use_future);
+        CHECK(reader.get() == std::vector{3, 4, 5, 6, 7});
+        CHECK(std::chrono::steady_clock::now() - start >= 50ms);
+
+        // Waiting readers are woken together once enough tokens accrued.
+        std::this_thread::sleep_for(30ms);
+        auto readers = std::vector<std::future<int>>{};
+        for (auto const i : std::views::iota(0, 6))
+        {
+            readers.push_back(asio::co_spawn(
+                thread_pool,
+                [limited]() -> asio::awaitable<int>
+                {
+                    co_return co_await limited.read();
+                },
+                asio::use_future));
+        }
+        auto values = std::vector<int>{};
+        for (auto& reader : readers)
+        {
+            values.push_back(reader.get());
+        }
+        std::ranges::sort(values);
+        CHECK(values == std::vector{8, 9, 10, 11, 12, 13});
+        CHECK(std::chrono::steady_clock::now() - start >= 100ms);
+
+        // Rates above one read per clock tick are limited to one per tick.
+        auto const fastest = asiochan::rate_limited{
+            thread_pool.get_executor(),
+            channel,
+            asiochan::rate_limit{.count = 1'000'000'000'000, .period = 1s, .burst = 2}};
+        CHECK(fastest.try_read() == 14);
+        CHECK(fastest.try_read() == 15);
+
+        using invalid_limited = asiochan::rate_limited<asiochan::unbounded_channel<int>>;
+        CHECK_THROWS_AS(invalid_limited(thread_pool.get_executor(), channel, asiochan::rate_limit{.count = 0}), std::invalid_argument);
+        CHECK_THROWS_AS(invalid_limited(thread_pool.get_executor(), channel, asiochan::rate_limit{.burst = 0}), std::invalid_argument);
+        CHECK_THROWS_AS(invalid_limited(thread_pool.get_executor(), channel, asiochan::rate_limit{.period = 0s}), std::invalid_argument);
+    }
+
+    SECTION("Delay channel")
+    {
+        using namespace std::chrono_literals;
+
+        // Values are expired in tick order across all levels of the wheel.
+        auto wheel = asiochan::detail::timing_wheel<std::uint64_t>{};
+        auto const ticks = std::vector<std::uint64_t>{1, 63, 64, 65, 4095, 4096, 100'000, 3'000'000'000};
+        for (auto const tick : ticks | std::views::reverse)
+        {
+            wheel.insert(tick, tick);
+        }
+        auto expired = std::vector<std::uint64_t>{};
+        wheel.advance(5'000, [&](std::uint64_t const tick) { expired.push_back(tick); });
+        CHECK(expired == std::vector<std::uint64_t>{1, 63, 64, 65, 4095, 4096});
+        CHECK(wheel.next_tick() <= std::optional<std::uint64_t>{100'000});
+        wheel.insert(5'001, 5'001);
+        wheel.advance(std::numeric_limits<std::uint32_t>::max(), [&](std::uint64_t const tick) { expired.push_back(tick); });
+        CHECK(expired == std::vector<std::uint64_t>{1, 63, 64, 65, 4095, 4096, 5'001, 100'000, 3'000'000'000});
+        CHECK(wheel.empty());
+
+        // Values due in a later block of 2^36 ticks are not expired early.
+        constexpr auto block = std::uint64_t{1} << 36;
+        auto far_expired = std::vector<std::uint64_t>{};
+        auto const record = [&](std::uint64_t const tick) { far_expired.push_back(tick); };
+        wheel.skip_to(block - 10);
+        for (auto const tick : {3 * block + 1, block + 5, block - 3, 2 * block - 11})
+        {
+            wheel.insert(tick, tick);
+        }
+        wheel.advance(block + 4, record);
+        CHECK(far_expired == std::vector<std::uint64_t>{block - 3});
+        CHECK(wheel.next_tick() <= std::optional<std::uint64_t>{block + 5});
+        wheel.advance(2 * block, record);
+        CHECK(far_expired == std::vector<std::uint64_t>{block - 3, block + 5, 2 * block - 11});
+        wheel.advance(3 * block, record);
+        CHECK(far_expired.size() == 3);
+        wheel.advance(3 * block + 1, record);
+        CHECK(far_expired.back() == 3 * block + 1);
+        CHECK(wheel.empty());
+
+        auto delayed = asiochan::delay_channel<int>{thread_pool.get_executor()};
+        auto const start = std::chrono::steady_clock::now();
+        delayed.write(3, 60ms);
+        delayed.write(1, 20ms);
+        delayed.write(2, 40ms);
+        delayed.write(0, 0ms);
+        CHECK(delayed.pending() == 3);
+        CHECK(delayed.try_read() == 0);
+        CHECK(not delayed.try_read().has_value());
+
+        auto reader = asio::co_spawn(
+            thread_pool,
+            [delayed, start]() -> asio::awaitable<std::vector<int>>
+            {
+                auto values = std::vector<int>{};
+                auto const reader = delayed.reader();
+                for (auto const i : std::views::iota(1, 4))
+                {
+                    auto const result = co_await asiochan::select(asiochan::ops::read(reader));
+                    CHECK(std::chrono::steady_clock::now() - start >= i * 20ms);
+                    values.push_back(result.get_received<int>());
+                }
+                co_return values;
+            },
+            asio::use_future);
+        CHECK(reader.get() == std::vector{1, 2, 3});
+        CHECK(delayed.pending() == 0);
+    }
+
+    SECTION("Ticker")
+    {
+        using namespace std::chrono_literals;
+
+        auto const executor = asio::any_io_executor{thread_pool.get_executor()};
+        auto const start = std::chrono::steady_clock::now();
+        auto tickers = std::vector<asiochan::ticker_channel>{};
+        for (auto const i : std::views::iota(0, 100))
+        {
+            tickers.push_back(asiochan::ticker(executor, 5ms + i * 100us));
+        }
+        CHECK(not tickers.front().try_read());
+
+        auto reader = asio::co_spawn(
+            thread_pool,
+            [tick = tickers.front()]() -> asio::awaitable<void>
+            {
+                for (auto const i : std::views::iota(0, 3))
+                {
+                    co_await tick.read();
+                }
+            },
+            asio::use_future);
+        reader.get();
+        CHECK(std::chrono::steady_clock::now() - start >= 15ms);
+
+        // Ticks that were not read are coalesced into one.
+        std::this_thread::sleep_for(50ms);
+        CHECK(tickers.back().try_read());
+        CHECK(not tickers.back().try_read());
+
+        tickers.clear();
+        std::this_thread::sleep_for(20ms);
+    }
+
+    SECTION("Sharded channel")
+    {
+        using namespace asiochan;
+
+        // Threads started one after another get different home shards.
+        auto homes = std::vector<std::size_t>{};
+        for (auto i = 0; i < 4; ++i)
+        {
+            std::thread{[&homes]() { homes.push_back(detail::home_shard(4)); }}.join();
+        }
+        std::ranges::sort(homes);
+        CHECK(homes == std::vector<std::size_t>{0, 1, 2, 3});
+
+        // The capacity is the buffer size of every shard together.
+        auto small = sharded_channel<int, 2, 3>{};
+        for (auto i = 0; i < 6; ++i)
+        {
+            CHECK(small.try_write(i));
+        }
+        CHECK(not small.try_write(6));
+
+        auto drained = std::vector<int>{};
+        while (auto value = small.try_read())
+        {
+            drained.push_back(*value);
+        }
+        std::ranges::sort(drained);
+        CHECK(drained == std::vector{0, 1, 2, 3, 4, 5});
+
+        constexpr auto num_writers = 4;
+        constexpr auto num_readers = 4;
+        constexpr auto values_per_writer = 500;
+        auto const sharded = sharded_channel<int, 4, 4>{};
+        for (auto writer = 0; writer < num_writers; ++writer)
+        {
+            asio::co_spawn(
+                thread_pool,
+                [sharded]() -> asio::awaitable<void>
+                {
+                    for (auto i = 1; i <= values_per_writer; ++i)
+                    {
+                        co_await sharded.write(i);
+                    }
+                },
+                asio::detached);
+        }
+
+        auto readers = std::vector<std::future<long long>>{};
+        for (auto reader = 0; reader < num_readers; ++reader)
+        {
+            readers.push_back(asio::co_spawn(
+                thread_pool,
+                [sharded]() -> asio::awaitable<long long>
+                {
+                    auto sum = 0ll;
+                    for (auto i = 0; i < num_writers * values_per_writer / num_readers; ++i)
+                    {
+                        sum += co_await sharded.read();
+                    }
+                    co_return sum;
+                },
+                asio::use_future));
+        }
+
+        auto total = 0ll;
+        for (auto& reader : readers)
+        {
+            total += reader.get();
+        }
+        CHECK(total == num_writers * static_cast<long long>(values_per_writer) * (values_per_writer + 1) / 2);
+        CHECK(not sharded.try_read().has_value());
+    }
+
+#if defined(__linux__)
+    SECTION("Shared memory channel")
+    {
+        using namespace asiochan;
+
+        auto const shm = shm_channel<int, 4>::create_anonymous();
+        auto const other = shm_channel<int, 4>::open_fd(shm.fd());
+        for (auto i = 0; i < 4; ++i)
+        {
+            CHECK(shm.try_write(i));
+        }
+        CHECK(not shm.try_write(4));
+        for (auto i = 0; i < 4; ++i)
+        {
+            CHECK(other.try_read() == i);
+        }
+        CHECK(not other.try_read().has_value());
+
+        using other_type_channel = shm_channel<long, 4>;
+        CHECK_THROWS_AS(other_type_channel::open_fd(shm.fd()), std::system_error);
+
+        // A child process blocks on the full ring while the parent reads.
+        constexpr auto num_values = 1000;
+        auto const child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0)
+        {
+            for (auto i = 1; i <= num_values; ++i)
+            {
+                shm.write_sync(i);
+            }
+            ::_exit(0);
+        }
+
+        auto sum = 0;
+        for (auto i = 0; i < num_values; ++i)
+        {
+            sum += other.read_sync();
+        }
+        auto status = 0;
+        CHECK(::waitpid(child, &status, 0) == child);
+        CHECK(sum == num_values * (num_values + 1) / 2);
 
-        auto ping_task = asio::co_spawn(
+        // Coroutines wait through the threads of the handle.
+        auto reader = asio::co_spawn(
             thread_pool,
-            [channel]() -> asio::awaitable<void>
+            [other]() -> asio::awaitable<int>
             {
-                co_await channel.write("ping");
-                auto const recv = co_await channel.read();
-                CHECK(recv == "pong");
+                auto sum = 0;
+                for (auto i = 0; i < num_values; ++i)
+                {
+                    sum += co_await other.read();
+                }
+                co_return sum;
             },
             asio::use_future);
+        asio::co_spawn(
+            thread_pool,
+            [shm]() -> asio::awaitable<void>
+            {
+                for (auto i = 1; i <= num_values; ++i)
+                {
+                    co_await shm.write(i);
+                }
+            },
+            asio::detached);
+        CHECK(reader.get() == num_values * (num_values + 1) / 2);
 
-        auto pong_task = asio::co_spawn(
+        auto const idle = channel<void>{};
+        auto selected = asio::co_spawn(
             thread_pool,
-            [channel]() -> asio::awaitable<void>
+            [reader = other.reader(), idle]() -> asio::awaitable<int>
             {
-                auto const recv = co_await channel.read();
-                CHECK(recv == "ping");
-                co_await channel.write("pong");
+                auto const result = co_await select(ops::read(reader), ops::read(idle));
+                co_return result.get_received<int>();
             },
             asio::use_future);
+        shm.write_sync(42);
+        CHECK(selected.get() == 42);
 
-        pong_task.get();
-        ping_task.get();
-    }
-
-    SECTION("Buffered channel")
-    {
-        static constexpr auto buffer_size = 3;
-
-        auto channel = asiochan::channel<int, buffer_size>{};
-        auto read_channel = asiochan::read_channel<int, buffer_size>{channel};
-        auto write_channel = asiochan::write_channel<int, buffer_size>{channel};
+        // A value is only taken from the ring for a reader that receives it.
+        auto other_won = asio::co_spawn(
+            thread_pool,
+            [reader = other.reader(), idle]() -> asio::awaitable<std::size_t>
+            {
+                auto const result = co_await select(ops::read(reader), ops::read(idle));
+                co_return result.alternative();
+            },
+            asio::use_future);
+        idle.write_sync();
+        CHECK(other_won.get() == 1);
+        shm.write_sync(43);
+        CHECK(other.read_sync() == 43);
 
-        for (auto const i : std::views::iota(0, buffer_size))
+        // A write completes only once its value is in the ring.
+        for (auto i = 0; i < 4; ++i)
         {
-            auto const was_sent = write_channel.try_write(i);
-            CHECK(was_sent);
+            CHECK(shm.try_write(i));
         }
-        auto const last_was_sent = write_channel.try_write(0);
-        CHECK(not last_was_sent);
-
-        for (auto const i : std::views::iota(0, buffer_size))
+        auto blocked = asio::co_spawn(thread_pool, shm.write(4), asio::use_future);
+        CHECK(blocked.wait_for(std::chrono::milliseconds{50}) == std::future_status::timeout);
+        CHECK(other.read_sync() == 0);
+        blocked.get();
+        for (auto i = 1; i <= 4; ++i)
         {
-            auto const recv = read_channel.try_read();
-            REQUIRE(recv.has_value());
-            CHECK(*recv == i);
+            CHECK(other.try_read() == i);
         }
-        auto const last_recv = read_channel.try_read();
-        CHECK(not last_recv.has_value());
     }
+#endif
 
-    SECTION("Concurrence buffered channel")
+    SECTION("Channel mutex policies")
     {
-        static constexpr auto buffer_size = 1;
+        using namespace asiochan;
+        constexpr auto num_values = 1000;
 
-        auto channel = asiochan::channel<int, buffer_size>{};
-        std::atomic_int sum {0};
-        for (size_t i = 0; i < 100; i++)
+        using spin_channel = basic_channel<int, 4, channel_stream_mode::block_until_available, asio::any_io_executor, spin_mutex>;
+        auto spin = spin_channel{};
+        for (auto writer = 0; writer < 2; ++writer)
         {
             asio::co_spawn(
                 thread_pool,
-                [channel, i]() -> asio::awaitable<void>
-                {
-                    co_await channel.write(i);
-                },
-                asio::use_future);
-            asio::co_spawn(
-                thread_pool,
-                [channel, &sum]() -> asio::awaitable<void>
+                [out = basic_write_channel<int, 4, channel_stream_mode::block_until_available, asio::any_io_executor, spin_mutex>{spin}]() -> asio::awaitable<void>
                 {
-                    auto i = co_await channel.read();
-                    ++sum;
+                    for (auto i = 1; i <= num_values; ++i)
+                    {
+                        co_await out.write(i);
+                    }
                 },
-                asio::use_future);
+                asio::detached);
         }
-        thread_pool.join();
-        CHECK(sum.load() == 100);
+        auto spin_reader = asio::co_spawn(
+            thread_pool,
+            [spin]() -> asio::awaitable<int>
+            {
+                auto sum = 0;
+                for (auto i = 0; i < 2 * num_values; ++i)
+                {
+                    auto const result = co_await select(ops::read(spin));
+                    sum += result.get_received<int>();
+                }
+                co_return sum;
+            },
+            asio::use_future);
+        CHECK(spin_reader.get() == num_values * (num_values + 1));
+
+        // A channel confined to a single threaded io_context needs no lock.
+        auto context = asio::io_context{};
+        auto local = basic_channel<int, 0, channel_stream_mode::block_until_available, asio::any_io_executor, null_mutex>{};
+        asio::co_spawn(
+            context,
+            [local]() -> asio::awaitable<void>
+            {
+                for (auto i = 1; i <= num_values; ++i)
+                {
+                    co_await local.write(i);
+                }
+            },
+            asio::detached);
+        auto local_reader = asio::co_spawn(
+            context,
+            [local]() -> asio::awaitable<int>
+            {
+                auto sum = 0;
+                for (auto i = 0; i < num_values; ++i)
+                {
+                    sum += co_await local.read();
+                }
+                CHECK(not local.try_read().has_value());
+                co_return sum;
+            },
+            asio::use_future);
+        context.run();
+        CHECK(local_reader.get() == num_values * (num_values + 1) / 2);
     }
 
-    SECTION("Buffered channel of void")
+    SECTION("Write many")
     {
-        static constexpr auto buffer_size = 3;
-
-        auto channel = asiochan::channel<void, buffer_size>{};
-        auto read_channel = asiochan::read_channel<void, buffer_size>{channel};
-        auto write_channel = asiochan::write_channel<void, buffer_size>{channel};
+        using namespace asiochan;
+        auto ioc = asio::io_context{};
+        auto unbuffered = channel<int>{};
+        auto received = std::vector<int>{};
 
-        for (auto const i : std::views::iota(0, buffer_size))
+        for (auto i = 0; i < 3; ++i)
         {
-            auto const was_sent = write_channel.try_write();
-            CHECK(was_sent);
+            asio::co_spawn(
+                ioc,
+                [unbuffered, &received]() -> asio::awaitable<void>
+                {
+                    received.push_back(co_await unbuffered.read());
+                },
+                asio::detached);
         }
-        auto const last_was_sent = write_channel.try_write();
-        CHECK(not last_was_sent);
+        ioc.poll();
 
-        for (auto const i : std::views::iota(0, buffer_size))
-        {
-            auto const recv = read_channel.try_read();
-            CHECK(recv);
-        }
-        auto const last_recv = read_channel.try_read();
-        CHECK(not last_recv);
-    }
+        auto values = std::vector{1, 2, 3, 4, 5};
+        CHECK(unbuffered.try_write_many(values) == 3);
 
-    SECTION("Unbounded buffered channel")
-    {
-        static constexpr auto num_tokens = 10;
+        // The readers are resumed from a single handler.
+        CHECK(ioc.poll_one() == 1);
+        CHECK(received == std::vector{1, 2, 3});
 
-        auto channel = asiochan::unbounded_channel<int>{};
-        auto read_channel = asiochan::unbounded_read_channel<int>{channel};
-        auto write_channel = asiochan::unbounded_write_channel<int>{channel};
+        auto buffered = channel<int, 4>{};
+        CHECK(buffered.try_write_many(std::span{values}.subspan(3)) == 2);
+        CHECK(buffered.try_write_many(values) == 2);
+        CHECK(buffered.try_read() == 4);
 
-        for (auto const i : std::views::iota(0, num_tokens))
-        {
-            write_channel.write(i);
-        }
+        auto done = false;
+        asio::co_spawn(
+            ioc,
+            [buffered, &done]() -> asio::awaitable<void>
+            {
+                auto values = std::vector<int>(6);
+                std::iota(values.begin(), values.end(), 10);
+                co_await buffered.write_many(std::move(values));
+                done = true;
+            },
+            asio::detached);
+        ioc.restart();
+        ioc.poll();
+        CHECK(not done);
 
-        for (auto const i : std::views::iota(0, num_tokens))
+        auto all = std::vector<int>{};
+        for (auto i = 0; i < 9; ++i)
         {
-            auto const recv = read_channel.try_read();
-            CHECK(recv == i);
+            all.push_back(*buffered.try_read());
+            ioc.poll();
         }
-        auto const last_recv = read_channel.try_read();
-        CHECK(not last_recv.has_value());
-    }
+        CHECK(done);
+        CHECK(all == std::vector{5, 1, 2, 10, 11, 12, 13, 14, 15});
 
-    SECTION("Channel of channel")
-    {
-        using CH0 = asiochan::channel<int>;
-        asiochan::channel<CH0> ch_of_ch0;
+        auto void_channel = channel<void, 2>{};
+        CHECK(void_channel.try_write_many(5) == 2);
+        CHECK(void_channel.try_read());
+        CHECK(void_channel.try_write_many(5) == 1);
     }
 
-    SECTION("Multiple writers and receivers")
+    SECTION("Losing waiters are removed when a select is claimed")
     {
-        static constexpr auto num_tokens_per_task = 5;
-        static constexpr auto num_tasks = 3;
-
-        auto channel = asiochan::channel<int>{};
-        auto read_channel = asiochan::read_channel<int>{channel};
-        auto write_channel = asiochan::write_channel<int>{channel};
-
-        auto source_values = std::vector<int>(num_tasks * num_tokens_per_task);
-        std::iota(source_values.begin(), source_values.end(), 0);
-
-        auto source_tasks = std::vector<std::future<void>>{};
-        for (auto const task_id : std::views::iota(0, num_tasks))
-        {
-            source_tasks.push_back(
-                asio::co_spawn(
-                    thread_pool,
-                    [write_channel, task_id, &source_values]() -> asio::awaitable<void>
-                    {
-                        auto const start = task_id * num_tokens_per_task;
-                        for (auto const i : std::views::iota(start, start + num_tokens_per_task))
-                        {
-                            co_await write_channel.write(source_values[i]);
-                        }
-                    },
-                    asio::use_future));
-        }
+        using namespace asiochan;
+        auto ioc = asio::io_context{};
+        auto a = channel<int>{};
+        auto b = channel<std::string>{};
+        auto done = false;
 
-        auto sink_values = std::vector<int>(num_tasks * num_tokens_per_task);
-        auto sink_tasks = std::vector<std::future<void>>{};
-        for (auto const task_id : std::views::iota(0, num_tasks))
-        {
-            sink_tasks.push_back(
-                asio::co_spawn(
-                    thread_pool,
-                    [read_channel, task_id, &sink_values]() -> asio::awaitable<void>
-                    {
-                        auto const start = task_id * num_tokens_per_task;
-                        for (auto const i : std::views::iota(start, start + num_tokens_per_task))
-                        {
-                            sink_values[i] = co_await read_channel.read();
-                        }
-                    },
-                    asio::use_future));
-        }
+        asio::co_spawn(
+            ioc,
+            [a, b, &done]() -> asio::awaitable<void>
+            {
+                auto const result = co_await select(ops::read(a), ops::read(b));
+                CHECK(result.get_received<int>() == 1);
+                done = true;
+            },
+            asio::detached);
+        ioc.poll();
+        CHECK(not b.shared_state_ptr()->reader_list().empty());
 
-        for (auto& sink_task : sink_tasks)
-        {
-            sink_task.get();
-        }
+        // The writer claims the select; its reader on b is unlinked before it resumes.
+        CHECK(a.try_write(1));
+        CHECK(b.shared_state_ptr()->reader_list().empty());
+        CHECK(not done);
+        ioc.run();
+        CHECK(done);
 
-        std::ranges::sort(sink_values);
-        CHECK(source_values == sink_values);
+        auto const& stats = b.shared_state_ptr()->reader_list().stats();
+        CHECK(stats.enqueued == 1);
+        CHECK(stats.removed == 1);
+        CHECK(stats.skipped == 0);
 
-        for (auto& source_task : source_tasks)
-        {
-            source_task.get();
-        }
+        // Nodes of a persistent selector stay registered, and are skipped while it is claimed.
+        auto selector_done = false;
+        asio::co_spawn(
+            ioc,
+            [a, b, &selector_done]() -> asio::awaitable<void>
+            {
+                auto waiter = selector{ops::read(a), ops::read(b)};
+                co_await waiter.wait();
+                selector_done = true;
+            },
+            asio::detached);
+        ioc.restart();
+        ioc.poll();
+        CHECK(a.try_write(2));
+        CHECK(not b.try_write("lost"));
+        CHECK(stats.skipped == 1);
+        ioc.run();
+        CHECK(selector_done);
     }
 
-    SECTION("Make sure crash when channel_waiter_list.dequeue not happen again")
+#ifdef ASIOCHAN_HAS_CANCELLATION_SLOT
+    SECTION("Cancelled select")
     {
         using namespace asiochan;
-        auto task = asio::co_spawn(
-            thread_pool,
-            []() -> asio::awaitable<void>
+        auto ioc = asio::io_context{};
+        auto ch = channel<int>{};
+        auto signal = asio::cancellation_signal{};
+        auto error = std::exception_ptr{};
+
+        asio::co_spawn(
+            ioc,
+            [ch]() -> asio::awaitable<void>
             {
-                auto executor = co_await asio::this_coro::executor;
-                channel<int, 1> ch {};
-                for (size_t i = 0; i < 2; i++)
-                {
-                    unbounded_channel<void> res {};
-                    for (size_t i = 0; i < 3; i++)
-                    {
-                        asio::co_spawn(executor, [ch, res]() -> asio::awaitable<void>{
-                            auto executor = co_await asio::this_coro::executor;
-                            auto timeouter = make_timeout(std::chrono::milliseconds(30), executor);
-                            co_await asiochan::select(
-                                asiochan::ops::read(timeouter),
-                                asiochan::ops::read(ch)
-                            );
-                            res.write();
-                        }, asio::detached);
-                    }
-                    for (size_t i = 0; i < 3; i++)
-                    {
-                        co_await res.read();
-                    }
-                }
+                co_await ch.read();
             },
-            asio::use_future
-        );
-        task.get();
+            asio::bind_cancellation_slot(
+                signal.slot(),
+                [&](std::exception_ptr const e)
+                {
+                    error = e;
+                }));
+
+        ioc.poll();
+        CHECK(not ch.shared_state_ptr()->reader_list().empty());
+        signal.emit(asio::cancellation_type::terminal);
+        ioc.run();
+
+        REQUIRE(error);
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (system::system_error const& e)
+        {
+            CHECK(e.code() == asio::error::operation_aborted);
+        }
+
+        // The cancelled reader is gone.
+        CHECK(ch.shared_state_ptr()->reader_list().empty());
+        CHECK(not ch.try_write(1));
     }
+#endif
 
     SECTION("Unblocked channel")
     {
@@ -618,4 +2234,44 @@ TEST_CASE("Channels")
             t1.join();
         }
     }
+
+    SECTION("Timed sync read and write")
+    {
+        using namespace asiochan;
+        using namespace std::chrono_literals;
+        {
+            channel<int> ch {};
+            auto const start = std::chrono::steady_clock::now();
+            CHECK(ch.read_sync_for(20ms) == std::nullopt);
+            CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+            CHECK(!ch.write_sync_for(20ms, 1));
+
+            // Nothing is left registered after a timeout.
+            std::thread t1([ch]() mutable {
+                ch.write_sync(2);
+            });
+            CHECK(ch.read_sync_until(std::chrono::steady_clock::now() + 5s) == 2);
+            t1.join();
+        }
+        {
+            channel<void, 1> ch {};
+            CHECK(ch.write_sync_for(20ms));
+            CHECK(!ch.write_sync_for(20ms));
+            CHECK(ch.read_sync_for(20ms));
+            CHECK(!ch.read_sync_for(20ms));
+        }
+        {
+            channel<void> a {};
+            channel<int> b {};
+            std::thread t1([b]() mutable {
+                b.write_sync(3);
+            });
+            auto result = select_sync_for(5s, ops::read(a), ops::read(b));
+            REQUIRE(result.has_value());
+            CHECK(result->received_from(b));
+            CHECK(result->get_received<int>() == 3);
+            t1.join();
+            CHECK(!select_sync_for(20ms, ops::read(a), ops::read(b)).has_value());
+        }
+    }
 }